@@ -379,10 +379,14 @@ namespace detail {
 
          if( _options->count("replay-blockchain") )
             _chain_db->wipe( _data_dir / "blockchain", false );
+         _chain_db->set_replay_check_signatures( _options->count("replay-check-signatures") > 0 );
 
          try
          {
-            _chain_db->open( _data_dir / "blockchain", initial_state, GRAPHENE_CURRENT_DB_VERSION );
+            fc::path snapshot;
+            if( _options->count("load-snapshot") )
+               snapshot = _options->at("load-snapshot").as<boost::filesystem::path>();
+            _chain_db->open( _data_dir / "blockchain", initial_state, GRAPHENE_CURRENT_DB_VERSION, snapshot );
          }
          catch( const fc::exception& e )
          {
@@ -932,6 +936,11 @@ void application::set_program_options(boost::program_options::options_descriptio
           "missing fields in a Genesis State will be added, and any unknown fields will be removed. If no file or an "
           "invalid file is found, it will be replaced with an example Genesis State.")
          ("replay-blockchain", "Rebuild object graph by replaying all blocks")
+         ("replay-check-signatures", "Check the signatures of witnesses and transactions when replaying blocks")
+         ("load-snapshot", bpo::value<boost::filesystem::path>(),
+          "Start from a binary snapshot written by the snapshot plugin, replacing the object graph, and replay the "
+          "stored blocks after it. Ignored once the node was started from it, refused if the block database holds "
+          "blocks but not the head block of the snapshot")
          ("resync-blockchain", "Delete all blocks and re-sync with network from scratch")
          ("force-validate", "Force validation of all transactions")
          ("genesis-timestamp", bpo::value<uint32_t>(), "Replace timestamp from genesis.json with current time plus this many seconds (experts only!)")
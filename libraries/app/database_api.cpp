@@ -48,6 +48,28 @@ namespace graphene { namespace app {
 
 class database_api_impl;
 
+/**
+ * A @ref credit_request_filter with the names resolved to ids
+ */
+struct resolved_credit_request_filter
+{
+   credit_request_filter        filter;
+   optional<account_id_type>    borrower;
+   optional<account_id_type>    creditor;
+   optional<asset_id_type>      loan_asset;
+
+   bool any_status( )const { return filter.status == e_credit_object_status::fetch_all; }
+   bool matches( const graphene::chain::database& db, const credit_object& credit )const;
+};
+
+struct credit_marketplace_subscription
+{
+   resolved_credit_request_filter            filter;
+   std::function<void(const variant&)>       callback;
+   /// status of every credit still open when it was last seen, the events are told apart by the status change
+   flat_map<object_id_type, e_credit_object_status> open_credits;
+};
+
 
 class database_api_impl : public std::enable_shared_from_this<database_api_impl>
 {
@@ -90,7 +112,15 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
                                                                       std::string creditor_user_id,
                                                                       uint32_t status
                                                                     ) const;
-    std::vector<karma_history_entry> list_account_history_of_karma(std::string account_id)const;
+      credit_request_page             list_credit_requests( const credit_request_filter& filter,
+                                                            optional<credit_request_cursor> start,
+                                                            uint32_t limit )const;
+    std::vector<karma_history_entry> list_account_history_of_karma(std::string account_id, uint32_t start, uint32_t limit)const;
+    std::vector<karma_history_entry> list_account_history_of_karma_by_time(std::string account_id, time_point_sec from, time_point_sec to, uint32_t limit)const;
+    vector<account_object> get_accounts_by_karma(float lower, float upper, uint32_t limit)const;
+    uint32_t get_karma_rank(std::string account_id)const;
+    optional<credit_statistics_object> get_credit_statistics(const string& asset_symbol_or_id)const;
+    vector<account_credit_statistics_object> get_account_credit_statistics(std::string account_id)const;
 
       // Exchange rates request
       map<string, string>           list_last_exchange_rates()const;
@@ -102,6 +132,8 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       void set_pending_transaction_callback( std::function<void(const variant&)> cb );
       void set_block_applied_callback( std::function<void(const variant& block_id)> cb );
       void cancel_all_subscriptions();
+      void subscribe_to_credit_marketplace( std::function<void(const variant&)> callback, const credit_request_filter& filter );
+      void unsubscribe_from_credit_marketplace();
 
       // Blocks and transactions
       optional<block_header> get_block_header(uint32_t block_num)const;
@@ -193,6 +225,15 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
 
 
    //private:
+      /// an unset result when a name of the filter is unknown, such a filter matches no credit
+      optional<resolved_credit_request_filter> resolve_credit_request_filter( const credit_request_filter& filter )const;
+      credit_request_page query_credit_requests( const credit_request_filter& filter,
+                                                 const optional<credit_request_cursor>& start,
+                                                 uint32_t limit )const;
+      vector<credit_object> fetch_credit_requests_from_index( const credit_request_filter& filter,
+                                                              uint32_t from_index,
+                                                              uint32_t elements_count )const;
+
       template<typename T>
       void subscribe_to_item( const T& i )const
       {
@@ -242,6 +283,8 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
 
       void broadcast_updates( const vector<variant>& updates );
       void broadcast_market_updates( const market_queue_type& queue);
+      void broadcast_credit_marketplace_updates( const vector<object_id_type>& ids, bool created, bool removed,
+                                                 std::function<const object*(object_id_type id)> find_object );
       void handle_object_changed(bool force_notify, bool full_object, const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts, std::function<const object*(object_id_type id)> find_object);
 
       /** called every time a block is applied to report the objects that were changed */
@@ -263,6 +306,7 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       boost::signals2::scoped_connection                                                                                           _applied_block_connection;
       boost::signals2::scoped_connection                                                                                           _pending_trx_connection;
       map< pair<asset_id_type,asset_id_type>, std::function<void(const variant&)> >      _market_subscriptions;
+      optional<credit_marketplace_subscription>                                                                                    _credit_marketplace_subscription;
       graphene::chain::database&                                                                                                            _db;
 };
 
@@ -392,6 +436,7 @@ void database_api_impl::cancel_all_subscriptions()
 {
    set_subscribe_callback( std::function<void(const fc::variant&)>(), true);
    _market_subscriptions.clear();
+   _credit_marketplace_subscription.reset();
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -1033,9 +1078,52 @@ vector<credit_object> database_api::fetch_credit_requests_stack_by_creditor( uin
                                              cyrrency_symbol, creditor_user_id, status );    
 }
 
-std::vector<karma_history_entry> database_api::list_account_history_of_karma(std::string account_id)const
+credit_request_page database_api::list_credit_requests( const credit_request_filter& filter,
+                                                       optional<credit_request_cursor> start,
+                                                       uint32_t limit )const
+{
+   return my->list_credit_requests( filter, start, limit );
+}
+
+void database_api::subscribe_to_credit_marketplace( std::function<void(const variant&)> callback,
+                                                    const credit_request_filter& filter )
+{
+   my->subscribe_to_credit_marketplace( callback, filter );
+}
+
+void database_api::unsubscribe_from_credit_marketplace()
+{
+   my->unsubscribe_from_credit_marketplace();
+}
+
+std::vector<karma_history_entry> database_api::list_account_history_of_karma(std::string account_id, uint32_t start, uint32_t limit)const
+{
+    return my->list_account_history_of_karma(account_id, start, limit);
+}
+
+std::vector<karma_history_entry> database_api::list_account_history_of_karma_by_time(std::string account_id, time_point_sec from, time_point_sec to, uint32_t limit)const
 {
-    return my->list_account_history_of_karma(account_id);
+    return my->list_account_history_of_karma_by_time(account_id, from, to, limit);
+}
+
+vector<account_object> database_api::get_accounts_by_karma(float lower, float upper, uint32_t limit)const
+{
+    return my->get_accounts_by_karma(lower, upper, limit);
+}
+
+uint32_t database_api::get_karma_rank(std::string account_id)const
+{
+    return my->get_karma_rank(account_id);
+}
+
+optional<credit_statistics_object> database_api::get_credit_statistics(const string& asset_symbol_or_id)const
+{
+    return my->get_credit_statistics(asset_symbol_or_id);
+}
+
+vector<account_credit_statistics_object> database_api::get_account_credit_statistics(std::string account_id)const
+{
+    return my->get_account_credit_statistics(account_id);
 }
 
 map<string, string> database_api::list_last_exchange_rates()const
@@ -1065,19 +1153,20 @@ vector<credit_object> database_api_impl::list_credit_requests_stack( uint32_t li
    while(limit-- && itr != assets_by_symbol.end())
       result.emplace_back(*itr++);
 
+   for( credit_object& credit : result )
+      credit.render_history( _db );
    return result;
 }
 
 vector<credit_object> database_api_impl::list_credit_request_by_uuid( string uuid )const
 {
-   const auto& assets_by_symbol = _db.get_index_type<credit_index>().indices().get<by_request_creation_time>();
    vector<credit_object> result;
 
-   for( auto it = assets_by_symbol.begin( ); it != assets_by_symbol.end( ); it++ )
-   {
-       if( ( *it ).object_uuid.compare( uuid ) == 0 )
-        result.emplace_back( *it );
-   }
+   const credit_object* credit = find_credit_by_uuid( _db, uuid );
+   if( credit != nullptr )
+      result.emplace_back( *credit );
+   for( credit_object& credit : result )
+      credit.render_history( _db );
    return result;    
 }
 
@@ -1094,71 +1183,21 @@ vector<credit_object> database_api_impl::fetch_credit_requests_stack( uint32_t f
                                                                       uint32_t status
                                                                     ) const
 {
-   const auto& request_by_time = _db.get_index_type<credit_index>( ).indices( ).get<by_request_creation_time>( );
-
-   vector<credit_object> result;
-   if( from_index > request_by_time.size( ) )
-        return result; 
-
-   result.reserve( elements_count );
-
-   auto b = request_by_time.rbegin( );
-   std::advance( b, from_index );
-   for( auto itr = b; itr != request_by_time.rend( ); itr++ )
-   {
-        const asset_object& loan_asset_type = ( *itr ).borrower.loan_asset.asset_id( _db );   
-        const asset_object& deposit_asset_type = ( *itr ).borrower.deposit_asset.asset_id( _db );   
-
-        if( user_id.size( ) > 0 )
-        {
-            auto borrower_account = lookup_account_names( {user_id} ).front( );
-            if( borrower_account.valid( ) )
-            {             
-                if( ( *itr ).borrower.borrower != borrower_account->id )
-                    continue;
-            }else     
-                continue;    
-        }
-
-        if( cyrrency_symbol.size( ) > 0 )
-        {
-            if( loan_asset_type.symbol != cyrrency_symbol )            
-                 continue;
-        }
- 
-        if( status != e_credit_object_status::fetch_all )
-        {
-            if( ( *itr ).status != status )          
-                continue; 
-        }
+   credit_request_filter filter;
+   if( user_id.size( ) > 0 )
+      filter.borrower = user_id;
+   if( cyrrency_symbol.size( ) > 0 )
+      filter.loan_asset = cyrrency_symbol;
+   filter.status = ( e_credit_object_status )status;
+   filter.loan_persent_from = loan_persent_from;
+   filter.loan_persent_to = loan_persent_to;
+   filter.loan_volume_from = loan_volume_from;
+   filter.loan_volume_to = loan_volume_to;
+   filter.deposit_volume_from = deposit_persent_from;
+   filter.deposit_volume_to = deposit_persent_to;
 
-        if( ( *itr ).borrower.loan_persent < loan_persent_from )     
-            continue;
-          
-        if( ( *itr ).borrower.loan_persent > loan_persent_to )    
-            continue;
- 
-        double loan_amount = loan_asset_type.amount_to_real( ( *itr ).borrower.loan_asset.amount );
-        if( loan_amount < ( double )loan_volume_from )       
-            continue;
-              
-        if( loan_amount > ( double )loan_volume_to )
-            continue;
- 
-        double deposit_amount = deposit_asset_type.amount_to_real( ( *itr ).borrower.deposit_asset.amount ); 
-        if( deposit_amount < ( double )deposit_persent_from )       
-            continue;
-             
-        if( deposit_amount > ( double )deposit_persent_to )      
-            continue;
- 
-        result.emplace_back( *itr );
-
-        if( result.size( ) >= elements_count )
-            break;
-   }
-   return result;    
-}                                        
+   return fetch_credit_requests_from_index( filter, from_index, elements_count );
+}
 
 vector<credit_object> database_api_impl::fetch_credit_requests_stack_by_creditor( uint32_t from_index,
                                                                       uint32_t elements_count,
@@ -1173,87 +1212,333 @@ vector<credit_object> database_api_impl::fetch_credit_requests_stack_by_creditor
                                                                       uint32_t status
                                                                     ) const
 {
+   credit_request_filter filter;
+   if( creditor_user_id.size( ) > 0 )
+      filter.creditor = creditor_user_id;
+   if( cyrrency_symbol.size( ) > 0 )
+      filter.loan_asset = cyrrency_symbol;
+   filter.status = ( e_credit_object_status )status;
+   filter.loan_persent_from = loan_persent_from;
+   filter.loan_persent_to = loan_persent_to;
+   filter.loan_volume_from = loan_volume_from;
+   filter.loan_volume_to = loan_volume_to;
+   filter.deposit_volume_from = deposit_persent_from;
+   filter.deposit_volume_to = deposit_persent_to;
+
+   return fetch_credit_requests_from_index( filter, from_index, elements_count );
+}
+
+vector<credit_object> database_api_impl::fetch_credit_requests_from_index( const credit_request_filter& filter,
+                                                                           uint32_t from_index,
+                                                                           uint32_t elements_count )const
+{
+   // from_index counts all credits newest first whatever the filter is, so it only positions the cursor
    const auto& request_by_time = _db.get_index_type<credit_index>( ).indices( ).get<by_request_creation_time>( );
+   if( from_index >= request_by_time.size( ) )
+      return vector<credit_object>( );
 
-   vector<credit_object> result;
-   if( from_index > request_by_time.size( ) )
-        return result; 
+   auto itr = request_by_time.rbegin( );
+   std::advance( itr, from_index );
+   credit_request_cursor start{ itr->request_creation_time, itr->id };
 
-   result.reserve( elements_count );
+   vector<credit_object> result = query_credit_requests( filter, start, elements_count ).credits;
+   for( credit_object& credit : result )
+      credit.render_history( _db );
+   return result;
+}
 
-   auto b = request_by_time.rbegin( );
-   std::advance( b, from_index );
-   for( auto itr = b; itr != request_by_time.rend( ); itr++ )
+namespace {
+   /**
+    * Credits of one range of a credit index keyed by ( ..., request_creation_time, id ), walked newest first.
+    */
+   class credit_run
    {
-        const asset_object& loan_asset_type = ( *itr ).borrower.loan_asset.asset_id( _db );   
-        const asset_object& deposit_asset_type = ( *itr ).borrower.deposit_asset.asset_id( _db );   
+      public:
+         virtual ~credit_run( ) {}
+
+         /// the current credit, nullptr once the run is exhausted
+         virtual const credit_object* current( )const = 0;
+         virtual void                 advance( ) = 0;
+         /// steps a separate counting position, false once it passed the oldest credit of the run
+         virtual bool                 probe( ) = 0;
+   };
 
-        if( creditor_user_id.size( ) > 0 )
-        {
-            auto creditor_account = lookup_account_names( {creditor_user_id} ).front( );
-            if( creditor_account.valid( ) )
-            {             
-                if( ( *itr ).creditor.creditor != creditor_account->id )
-                    continue;
-            }else     
-                continue;    
-        }
+   template<typename Index>
+   class credit_index_run : public credit_run
+   {
+      public:
+         typedef typename Index::const_iterator iterator;
 
-        if( cyrrency_symbol.size( ) > 0 )
-        {
-            if( loan_asset_type.symbol != cyrrency_symbol )            
-                 continue;
-        }
- 
-        if( status != e_credit_object_status::fetch_all )
-        {
-            if( ( *itr ).status != status )          
-                continue; 
-        }
+         credit_index_run( iterator begin, iterator end ) : _begin( begin ), _pos( end ), _probe( end ) {}
 
-        if( ( *itr ).borrower.loan_persent < loan_persent_from )     
-            continue;
-          
-        if( ( *itr ).borrower.loan_persent > loan_persent_to )    
-            continue;
- 
-        double loan_amount = loan_asset_type.amount_to_real( ( *itr ).borrower.loan_asset.amount );
-        if( loan_amount < ( double )loan_volume_from )       
-            continue;
-              
-        if( loan_amount > ( double )loan_volume_to )
-            continue;
- 
-        double deposit_amount = deposit_asset_type.amount_to_real( ( *itr ).borrower.deposit_asset.amount ); 
-        if( deposit_amount < ( double )deposit_persent_from )       
-            continue;
-             
-        if( deposit_amount > ( double )deposit_persent_to )      
-            continue;
- 
-        result.emplace_back( *itr );
-
-        if( result.size( ) >= elements_count )
-            break;
+         virtual const credit_object* current( )const override { return _pos == _begin ? nullptr : &*std::prev( _pos ); }
+         virtual void                 advance( ) override { --_pos; }
+         virtual bool                 probe( ) override
+         {
+            if( _probe == _begin )
+               return false;
+            --_probe;
+            return true;
+         }
+
+      private:
+         iterator _begin;
+         iterator _pos;
+         iterator _probe;
+   };
+
+   template<typename Index, typename Prefix, typename Bound>
+   std::unique_ptr<credit_run> make_credit_run( const Index& idx, const Prefix& prefix, const Bound& bound, bool bounded )
+   {
+      return std::unique_ptr<credit_run>( new credit_index_run<Index>( idx.lower_bound( prefix ),
+                                                                       bounded ? idx.upper_bound( bound ) : idx.upper_bound( prefix ) ) );
    }
-   return result;    
+
+   template<typename Index, typename Bound>
+   std::unique_ptr<credit_run> make_credit_run( const Index& idx, const Bound& bound, bool bounded )
+   {
+      return std::unique_ptr<credit_run>( new credit_index_run<Index>( idx.begin( ), bounded ? idx.upper_bound( bound ) : idx.end( ) ) );
+   }
+}
+
+credit_request_page database_api_impl::list_credit_requests( const credit_request_filter& filter,
+                                                             optional<credit_request_cursor> start,
+                                                             uint32_t limit )const
+{
+   FC_ASSERT( limit <= 100 );
+   credit_request_page page = query_credit_requests( filter, start, limit );
+   for( credit_object& credit : page.credits )
+      credit.render_history( _db );
+   return page;
+}
+
+credit_request_page database_api_impl::query_credit_requests( const credit_request_filter& filter,
+                                                              const optional<credit_request_cursor>& start,
+                                                              uint32_t limit )const
+{
+   credit_request_page page;
+
+   // the names are resolved once, an unknown name matches no credit
+   optional<resolved_credit_request_filter> resolved = resolve_credit_request_filter( filter );
+   if( !resolved.valid( ) )
+      return page;
+   const optional<account_id_type>& borrower   = resolved->borrower;
+   const optional<account_id_type>& creditor   = resolved->creditor;
+   const optional<asset_id_type>&   loan_asset = resolved->loan_asset;
+   bool any_status = resolved->any_status( );
+
+   // every index whose key prefix is fixed by the filter can serve the query
+   const auto& indices = _db.get_index_type<credit_index>( ).indices( );
+   bool bounded = start.valid( );
+   time_point_sec start_time = bounded ? start->request_creation_time : time_point_sec( );
+   object_id_type start_id = bounded ? object_id_type( start->id ) : object_id_type( );
+
+   std::vector<std::unique_ptr<credit_run>> candidates;
+   if( borrower.valid( ) )
+      candidates.push_back( make_credit_run( indices.get<by_borrower>( ), boost::make_tuple( *borrower ),
+                                             boost::make_tuple( *borrower, start_time, start_id ), bounded ) );
+   if( creditor.valid( ) )
+      candidates.push_back( make_credit_run( indices.get<by_creditor>( ), boost::make_tuple( *creditor ),
+                                             boost::make_tuple( *creditor, start_time, start_id ), bounded ) );
+   if( !any_status && loan_asset.valid( ) )
+      candidates.push_back( make_credit_run( indices.get<by_status_loan_asset>( ), boost::make_tuple( filter.status, *loan_asset ),
+                                             boost::make_tuple( filter.status, *loan_asset, start_time, start_id ), bounded ) );
+   if( candidates.empty( ) )
+      candidates.push_back( make_credit_run( indices.get<by_request_creation_time>( ),
+                                             boost::make_tuple( start_time, start_id ), bounded ) );
+
+   // the candidate with the fewest credits in range wins, found by stepping all of them until the first one ends
+   size_t plan = 0;
+   if( candidates.size( ) > 1 )
+   {
+      bool found = false;
+      while( !found )
+         for( size_t i = 0; i < candidates.size( ) && !found; ++i )
+            if( !candidates[i]->probe( ) )
+            {
+               plan = i;
+               found = true;
+            }
+   }
+   credit_run& run = *candidates[plan];
+
+   for( const credit_object* credit = run.current( ); credit != nullptr; run.advance( ), credit = run.current( ) )
+   {
+      if( !resolved->matches( _db, *credit ) )
+         continue;
+
+      if( page.credits.size( ) >= limit )
+      {
+         page.next = credit_request_cursor{ credit->request_creation_time, credit->id };
+         break;
+      }
+      page.credits.emplace_back( *credit );
+   }
+   return page;
+}
+
+bool resolved_credit_request_filter::matches( const graphene::chain::database& db, const credit_object& credit )const
+{
+   if( borrower.valid( ) && credit.borrower.borrower != *borrower )
+      return false;
+   if( creditor.valid( ) && credit.creditor.creditor != *creditor )
+      return false;
+   if( loan_asset.valid( ) && credit.borrower.loan_asset.asset_id != *loan_asset )
+      return false;
+   if( !any_status( ) && credit.status != filter.status )
+      return false;
+   if( credit.borrower.loan_persent < filter.loan_persent_from || credit.borrower.loan_persent > filter.loan_persent_to )
+      return false;
+
+   double loan_amount = credit.borrower.loan_asset.asset_id( db ).amount_to_real( credit.borrower.loan_asset.amount );
+   if( loan_amount < ( double )filter.loan_volume_from || loan_amount > ( double )filter.loan_volume_to )
+      return false;
+
+   double deposit_amount = credit.borrower.deposit_asset.asset_id( db ).amount_to_real( credit.borrower.deposit_asset.amount );
+   if( deposit_amount < ( double )filter.deposit_volume_from || deposit_amount > ( double )filter.deposit_volume_to )
+      return false;
+
+   return true;
+}
+
+optional<resolved_credit_request_filter> database_api_impl::resolve_credit_request_filter( const credit_request_filter& filter )const
+{
+   auto account_from_string = [this]( const string& name_or_id ) -> const account_object* {
+      if( !name_or_id.empty( ) && std::isdigit( static_cast<unsigned char>( name_or_id[0] ) ) )
+         return _db.find( fc::variant( name_or_id ).as<account_id_type>( ) );
+      const auto& idx = _db.get_index_type<account_index>( ).indices( ).get<by_name>( );
+      auto itr = idx.find( name_or_id );
+      return itr == idx.end( ) ? nullptr : &*itr;
+   };
+
+   resolved_credit_request_filter resolved;
+   resolved.filter = filter;
+   if( filter.borrower.valid( ) )
+   {
+      const account_object* account = account_from_string( *filter.borrower );
+      if( account == nullptr )
+         return optional<resolved_credit_request_filter>( );
+      resolved.borrower = account->id;
+   }
+   if( filter.creditor.valid( ) )
+   {
+      const account_object* account = account_from_string( *filter.creditor );
+      if( account == nullptr )
+         return optional<resolved_credit_request_filter>( );
+      resolved.creditor = account->id;
+   }
+   if( filter.loan_asset.valid( ) )
+   {
+      auto asset = lookup_asset_symbols( { *filter.loan_asset } ).front( );
+      if( !asset.valid( ) )
+         return optional<resolved_credit_request_filter>( );
+      resolved.loan_asset = asset->id;
+   }
+   return resolved;
 }
 
-std::vector<karma_history_entry> database_api_impl::list_account_history_of_karma(std::string account_id)const
+void database_api_impl::subscribe_to_credit_marketplace( std::function<void(const variant&)> callback,
+                                                         const credit_request_filter& filter )
 {
+   optional<resolved_credit_request_filter> resolved = resolve_credit_request_filter( filter );
+   FC_ASSERT( resolved.valid( ), "unknown account or asset in the filter" );
+   credit_marketplace_subscription subscription{ *resolved, callback };
+
+   const auto& credits = _db.get_index_type<credit_index>().indices().get<by_status>();
+   for( auto status : { e_credit_object_status::wating_for_acceptance, e_credit_object_status::in_progress } )
+   {
+      auto range = credits.equal_range( boost::make_tuple( status ) );
+      for( const credit_object& credit : boost::make_iterator_range( range.first, range.second ) )
+         subscription.open_credits.emplace( credit.id, credit.status );
+   }
+
+   _credit_marketplace_subscription = std::move( subscription );
+}
+
+void database_api_impl::unsubscribe_from_credit_marketplace()
+{
+   _credit_marketplace_subscription.reset();
+}
+
+std::vector<karma_history_entry> database_api_impl::list_account_history_of_karma(std::string account_id, uint32_t start, uint32_t limit)const
+{
+    FC_ASSERT( limit <= 100 );
     std::vector<karma_history_entry> result;
-    const auto& account_history_of_karma_objs = _db.get_index_type<account_history_of_karma_index>().indices().get<by_id>();
     auto account = lookup_account_names( {account_id} ).front( );
     if(account.valid())
     {
-        for (auto const& history : account_history_of_karma_objs)
-        {
-            if(account->id == history.account)
-            {
-                result = history.get_karma_history();
-                return result;
-            }
-        }
+        const auto& entries = _db.get_index_type<karma_history_entry_index>().indices().get<by_account_seq>();
+        auto itr = entries.lower_bound( boost::make_tuple( account->id, start ) );
+        auto end = entries.upper_bound( boost::make_tuple( account->id ) );
+        for( ; itr != end && result.size() < limit; ++itr )
+            result.push_back( itr->to_entry() );
+    }
+    return result;
+}
+
+std::vector<karma_history_entry> database_api_impl::list_account_history_of_karma_by_time(std::string account_id, time_point_sec from, time_point_sec to, uint32_t limit)const
+{
+    FC_ASSERT( limit <= 100 );
+    std::vector<karma_history_entry> result;
+    auto account = lookup_account_names( {account_id} ).front( );
+    if(account.valid())
+    {
+        const auto& entries = _db.get_index_type<karma_history_entry_index>().indices().get<by_account_date>();
+        auto itr = entries.lower_bound( boost::make_tuple( account->id, from ) );
+        auto end = entries.upper_bound( boost::make_tuple( account->id, to ) );
+        for( ; itr != end && result.size() < limit; ++itr )
+            result.push_back( itr->to_entry() );
+    }
+    return result;
+}
+
+vector<account_object> database_api_impl::get_accounts_by_karma(float lower, float upper, uint32_t limit)const
+{
+    FC_ASSERT( limit <= 1000 );
+    vector<account_object> result;
+    if( lower > upper )
+        return result;
+
+    const auto& accounts_by_karma = _db.get_index_type<account_index>().indices().get<by_karma>();
+    auto begin = accounts_by_karma.lower_bound( boost::make_tuple( lower ) );
+    auto itr = accounts_by_karma.upper_bound( boost::make_tuple( upper ) );
+    while( itr != begin && result.size() < limit )
+        result.push_back( *--itr );
+    return result;
+}
+
+uint32_t database_api_impl::get_karma_rank(std::string account_id)const
+{
+    auto account = lookup_account_names( {account_id} ).front( );
+    FC_ASSERT( account.valid(), "unknown account ${a}", ("a", account_id) );
+
+    const auto& karma_index = dynamic_cast<const primary_index<account_index>&>( _db.get_index_type<account_index>() )
+                                 .get_secondary_index<graphene::chain::account_karma_index>();
+    return karma_index.count_above( account->karma ) + 1;
+}
+
+optional<credit_statistics_object> database_api_impl::get_credit_statistics(const string& asset_symbol_or_id)const
+{
+    auto asset = lookup_asset_symbols( {asset_symbol_or_id} ).front( );
+    FC_ASSERT( asset.valid(), "unknown asset ${a}", ("a", asset_symbol_or_id) );
+
+    const auto& stats_by_asset = _db.get_index_type<credit_statistics_index>().indices().get<by_asset>();
+    auto itr = stats_by_asset.find( asset->id );
+    if( itr == stats_by_asset.end() )
+        return optional<credit_statistics_object>();
+    return *itr;
+}
+
+vector<account_credit_statistics_object> database_api_impl::get_account_credit_statistics(std::string account_id)const
+{
+    vector<account_credit_statistics_object> result;
+    auto account = lookup_account_names( {account_id} ).front( );
+    if(account.valid())
+    {
+        const auto& stats = _db.get_index_type<account_credit_statistics_index>().indices().get<by_account_asset>();
+        auto range = stats.equal_range( boost::make_tuple( account->id ) );
+        for( auto itr = range.first; itr != range.second; ++itr )
+            result.push_back( *itr );
     }
     return result;
 }
@@ -1274,17 +1559,17 @@ map<string, string> database_api_impl::list_last_exchange_rates()const
 
 map< std::string, std::map< account_id_type, string >> database_api_impl::list_current_exchange_rates()const
 {
-    const auto& exch_object = _db.get_index_type<exchange_rate_index>().indices().get<by_id>();
+    const auto& votes_by_symbol = _db.get_index_type<exchange_rate_votes_index>().indices().get<by_symbol>();
 
     map< std::string, std::map< account_id_type, string >> result;
 
     // by currency
-    for (auto const& current_exch_it : (*exch_object.begin()).current_exchange_rate)
+    for (auto const& votes : votes_by_symbol)
     {
         // by accounts
-        for(auto const& account_id_it : current_exch_it.second)
+        for(auto const& account_id_it : votes.votes)
         {
-            result[current_exch_it.first][account_id_it.first] = std::to_string(account_id_it.second);
+            result[votes.symbol][account_id_it.first] = std::to_string(account_id_it.second);
         }
     }
 
@@ -1293,7 +1578,7 @@ map< std::string, std::map< account_id_type, string >> database_api_impl::list_c
 
 graphene::chain::chain_parameters::ext::credit_options database_api_impl::list_global_extensions()const
 {
-    return get_global_properties().parameters.get_credit_options();
+    return _db.get_credit_options();
 }
 
 vector<asset_object> database_api_impl::list_assets(const string& lower_bound_symbol, uint32_t limit)const
@@ -2464,34 +2749,95 @@ void database_api_impl::broadcast_market_updates( const market_queue_type& queue
    }
 }
 
-void database_api_impl::on_objects_removed( const vector<object_id_type>& ids, const vector<const object*>& objs, const flat_set<account_id_type>& impacted_accounts)
+void database_api_impl::broadcast_credit_marketplace_updates( const vector<object_id_type>& ids, bool created, bool removed,
+                                                              std::function<const object*(object_id_type id)> find_object )
 {
-   handle_object_changed(_notify_remove_create, false, ids, impacted_accounts,
-      [objs](object_id_type id) -> const object* {
-         auto it = std::find_if(
-               objs.begin(), objs.end(),
-               [id](const object* o) {return o != nullptr && o->id == id;});
+   if( !_credit_marketplace_subscription.valid() )
+      return;
 
-         if (it != objs.end())
-            return *it;
+   const resolved_credit_request_filter& filter = _credit_marketplace_subscription->filter;
+   auto& open_credits = _credit_marketplace_subscription->open_credits;
+   vector<credit_marketplace_update> updates;
 
-         return nullptr;
+   for( auto id : ids )
+   {
+      if( !id.is<credit_object>() )
+         continue;
+      const credit_object* credit = dynamic_cast<const credit_object*>( find_object(id) );
+      if( credit == nullptr )
+         continue;
+
+      // evaluators stamp the history with the time of the previous block, so only the status change tells what happened
+      auto previous = open_credits.find( id );
+      bool status_changed = previous != open_credits.end() && previous->second != credit->status;
+      if( removed || ( credit->status != e_credit_object_status::wating_for_acceptance &&
+                       credit->status != e_credit_object_status::in_progress ) )
+      {
+         if( previous != open_credits.end() )
+            open_credits.erase( previous );
       }
-   );
+      else if( previous != open_credits.end() )
+         previous->second = credit->status;
+      else
+         open_credits.emplace( id, credit->status );
+
+      if( !filter.matches( _db, *credit ) )
+         continue;
+
+      credit_marketplace_event event = credit_updated;
+      if( removed )
+         event = credit_cancelled;
+      else if( created )
+         event = credit_requested;
+      else if( status_changed && credit->status == e_credit_object_status::in_progress )
+         event = credit_approved;
+      else if( status_changed && credit->status == e_credit_object_status::complete_normal )
+         event = credit_settled;
+      else if( status_changed && credit->status == e_credit_object_status::complete_ubnormal )
+         event = credit_defaulted;
+
+      updates.emplace_back( credit_marketplace_update{ event, *credit } );
+      updates.back().credit.render_history( _db );
+   }
+
+   if( updates.size() )
+   {
+      auto capture_this = shared_from_this();
+      fc::async([capture_this, this, updates](){
+         if( _credit_marketplace_subscription.valid() )
+            _credit_marketplace_subscription->callback( fc::variant(updates) );
+      });
+   }
+}
+
+void database_api_impl::on_objects_removed( const vector<object_id_type>& ids, const vector<const object*>& objs, const flat_set<account_id_type>& impacted_accounts)
+{
+   auto find_removed = [objs](object_id_type id) -> const object* {
+      auto it = std::find_if(
+            objs.begin(), objs.end(),
+            [id](const object* o) {return o != nullptr && o->id == id;});
+
+      if (it != objs.end())
+         return *it;
+
+      return nullptr;
+   };
+   handle_object_changed(_notify_remove_create, false, ids, impacted_accounts, find_removed);
+   broadcast_credit_marketplace_updates(ids, false, true, find_removed);
 }
 
 void database_api_impl::on_objects_new(const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts)
 {
-   handle_object_changed(_notify_remove_create, true, ids, impacted_accounts,
-      std::bind(&object_database::find_object, &_db, std::placeholders::_1)
-   );
+   auto find_object = std::bind(&object_database::find_object, &_db, std::placeholders::_1);
+   handle_object_changed(_notify_remove_create, true, ids, impacted_accounts, find_object);
+   broadcast_credit_marketplace_updates(ids, true, false, find_object);
 }
 
 void database_api_impl::on_objects_changed(const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts)
 {
-   handle_object_changed(false, true, ids, impacted_accounts,
-      std::bind(&object_database::find_object, &_db, std::placeholders::_1)
-   );
+   auto find_object = std::bind(&object_database::find_object, &_db, std::placeholders::_1);
+   handle_object_changed(false, true, ids, impacted_accounts, find_object);
+   broadcast_credit_marketplace_updates(ids, false, false, find_object);
 }
 
 void database_api_impl::handle_object_changed(bool force_notify, bool full_object, const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts, std::function<const object*(object_id_type id)> find_object)
@@ -41,6 +41,7 @@
 #include <graphene/chain/worker_object.hpp>
 #include <graphene/chain/witness_object.hpp>
 #include <graphene/chain/credit_object.hpp>
+#include <graphene/chain/credit_statistics_object.hpp>
 #include <graphene/chain/exchange_rate_object.hpp>
 
 #include <graphene/market_history/market_history_plugin.hpp>
@@ -54,6 +55,7 @@
 #include <boost/container/flat_set.hpp>
 
 #include <functional>
+#include <limits>
 #include <map>
 #include <memory>
 #include <vector>
@@ -114,6 +116,58 @@ struct market_trade
    account_id_type            side2_account_id = GRAPHENE_NULL_ACCOUNT;
 };
 
+/**
+ * @brief Filter of @ref database_api::list_credit_requests, fields left unset match every credit request
+ */
+struct credit_request_filter
+{
+   optional<string>           borrower;      ///< name or id of the borrower
+   optional<string>           creditor;      ///< name or id of the creditor
+   optional<string>           loan_asset;    ///< symbol or id of the loan asset
+   e_credit_object_status     status = e_credit_object_status::fetch_all;
+   uint32_t                   loan_persent_from = 0;
+   uint32_t                   loan_persent_to = std::numeric_limits<uint32_t>::max();
+   uint32_t                   loan_volume_from = 0;
+   uint32_t                   loan_volume_to = std::numeric_limits<uint32_t>::max();
+   uint32_t                   deposit_volume_from = 0;
+   uint32_t                   deposit_volume_to = std::numeric_limits<uint32_t>::max();
+};
+
+/**
+ * @brief Position in the newest first order of credit requests
+ */
+struct credit_request_cursor
+{
+   time_point_sec             request_creation_time;
+   credit_id_type             id;
+};
+
+struct credit_request_page
+{
+   vector<credit_object>             credits;
+   /// start of the following page, unset on the last page
+   optional<credit_request_cursor>   next;
+};
+
+/**
+ * @brief What happened to a credit pushed by @ref database_api::subscribe_to_credit_marketplace
+ */
+enum credit_marketplace_event
+{
+   credit_requested = 0,   ///< a new request waits for a creditor
+   credit_approved,        ///< a creditor accepted the request
+   credit_updated,         ///< a monthly payment or comment changed a running credit
+   credit_settled,         ///< the loan has been paid back
+   credit_defaulted,       ///< the deposit has been transfered to the creditor
+   credit_cancelled        ///< the borrower withdrew the request
+};
+
+struct credit_marketplace_update
+{
+   credit_marketplace_event          event;
+   credit_object                     credit;
+};
+
 /**
  * @brief The database_api class implements the RPC API for the chain database.
  *
@@ -160,7 +214,75 @@ class database_api
                                                                       uint32_t status
                                                                     ) const;                                                                    
 
-      std::vector<karma_history_entry> list_account_history_of_karma(std::string account_id)const;
+      /**
+       * @brief Get credit requests matching a filter, newest first
+       * @param filter credits to return
+       * @param start position to continue from, the @ref credit_request_page::next of the previous page; unset for the first page
+       * @param limit maximum number of credits to return, at most 100
+       *
+       * The most selective index fixed by the filter is walked, so the cost follows the number of matching credits
+       * instead of the number of credits ever created.
+       */
+      credit_request_page list_credit_requests( const credit_request_filter& filter,
+                                                optional<credit_request_cursor> start,
+                                                uint32_t limit )const;
+
+      /**
+       * @brief Request notification when credits matching a filter change
+       * @param callback Callback method which is called once per block with the changed credits
+       * @param filter credits to report, the same filter as @ref list_credit_requests
+       *
+       * Callback will be passed a variant containing a vector<credit_marketplace_update>. The status of the filter is
+       * matched against the status after the change. A new subscription replaces the previous one.
+       */
+      void subscribe_to_credit_marketplace( std::function<void(const variant&)> callback,
+                                            const credit_request_filter& filter );
+
+      /**
+       * @brief Unsubscribe from credit marketplace updates
+       */
+      void unsubscribe_from_credit_marketplace();
+
+      /**
+       * @brief Get the karma history of an account, oldest entries first
+       * @param account_id name or id of the account
+       * @param start sequence number of the first entry to return
+       * @param limit maximum number of entries to return, at most 100
+       */
+      std::vector<karma_history_entry> list_account_history_of_karma(std::string account_id, uint32_t start, uint32_t limit)const;
+
+      /**
+       * @brief Get the karma history of an account recorded between @p from and @p to inclusive, oldest entries first
+       * @param account_id name of the account
+       * @param limit maximum number of entries to return, at most 100
+       */
+      std::vector<karma_history_entry> list_account_history_of_karma_by_time(std::string account_id, time_point_sec from, time_point_sec to, uint32_t limit)const;
+
+      /**
+       * @brief Get the accounts with a karma between @p lower and @p upper inclusive, highest karma first
+       * @param limit maximum number of accounts to return, at most 1000
+       */
+      vector<account_object> get_accounts_by_karma(float lower, float upper, uint32_t limit)const;
+
+      /**
+       * @brief Get the position of an account when all accounts are ordered by karma, highest first
+       * @param account_id name of the account
+       * @return 1 plus the number of accounts with a greater karma, accounts with the same karma share the rank
+       */
+      uint32_t get_karma_rank(std::string account_id)const;
+
+      /**
+       * @brief Get the totals of all credits in an asset
+       * @param asset_symbol_or_id symbol or id of the asset
+       * @return the totals, unset when no credit ever used the asset
+       */
+      optional<credit_statistics_object> get_credit_statistics(const string& asset_symbol_or_id)const;
+
+      /**
+       * @brief Get the totals of the credits of an account, one object per asset the account borrowed, lent or pledged
+       * @param account_id name of the account
+       */
+      vector<account_credit_statistics_object> get_account_credit_statistics(std::string account_id)const;
 
       map<string, string> list_last_exchange_rates()const;
       map< std::string, std::map< account_id_type, string >> list_current_exchange_rates()const;
@@ -670,6 +792,14 @@ FC_REFLECT( graphene::app::market_ticker,
             (time)(base)(quote)(latest)(lowest_ask)(highest_bid)(percent_change)(base_volume)(quote_volume) );
 FC_REFLECT( graphene::app::market_volume, (time)(base)(quote)(base_volume)(quote_volume) );
 FC_REFLECT( graphene::app::market_trade, (sequence)(date)(price)(amount)(value)(side1_account_id)(side2_account_id) );
+FC_REFLECT( graphene::app::credit_request_filter,
+            (borrower)(creditor)(loan_asset)(status)(loan_persent_from)(loan_persent_to)
+            (loan_volume_from)(loan_volume_to)(deposit_volume_from)(deposit_volume_to) );
+FC_REFLECT( graphene::app::credit_request_cursor, (request_creation_time)(id) );
+FC_REFLECT( graphene::app::credit_request_page, (credits)(next) );
+FC_REFLECT_ENUM( graphene::app::credit_marketplace_event,
+                 (credit_requested)(credit_approved)(credit_updated)(credit_settled)(credit_defaulted)(credit_cancelled) )
+FC_REFLECT( graphene::app::credit_marketplace_update, (event)(credit) );
 
 FC_API(graphene::app::database_api,
    // Objects
@@ -720,8 +850,16 @@ FC_API(graphene::app::database_api,
    (fetch_credit_requests_stack)
    (fetch_credit_requests_stack_by_creditor)
    (list_credit_request_by_uuid)
+   (list_credit_requests)
+   (subscribe_to_credit_marketplace)
+   (unsubscribe_from_credit_marketplace)
 
    (list_account_history_of_karma)
+   (list_account_history_of_karma_by_time)
+   (get_accounts_by_karma)
+   (get_karma_rank)
+   (get_credit_statistics)
+   (get_account_credit_statistics)
 
     // Exchange rate request
    (list_last_exchange_rates)
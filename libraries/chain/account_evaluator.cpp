@@ -217,8 +217,8 @@ object_id_type account_create_evaluator::do_apply( const account_create_operatio
          db().create<account_history_of_karma_object>([&](account_history_of_karma_object& h)
          {
                   h.account = obj.id;
-                  h.add_history_entry(db().head_block_time(), KARMA_BONUS_FOR_ACCOUNT_CREATE, "Account created.");
          });
+         add_karma_history_entry(db(), obj.id, KARMA_BONUS_FOR_ACCOUNT_CREATE, karma_account_created);
 
          if( o.extensions.value.owner_special_authority.valid() )
             obj.owner_special_authority = *(o.extensions.value.owner_special_authority);
@@ -28,6 +28,8 @@
 #include <graphene/chain/credit_object.hpp>
 #include <fc/uint128.hpp>
 
+#include <cstring>
+
 namespace graphene { namespace chain {
 
 share_type cut_fee(share_type a, uint16_t p)
@@ -278,23 +280,203 @@ void account_object::update_karma(float amount)
         karma = KARMA_MAX_VALUE;
 }
 
-void update_account_karma(graphene::chain::database* db, account_id_type account_id, float amount, std::string info)
+namespace {
+   /// -0 and 0 are the same karma
+   float normalized_karma( float karma ) { return karma == 0 ? 0.0f : karma; }
+
+   /// a hash of the value, balances the treap like a random priority while keeping it deterministic
+   uint32_t karma_priority( float karma )
+   {
+      uint32_t bits;
+      memcpy( &bits, &karma, sizeof( bits ) );
+      bits ^= bits >> 16;
+      bits *= 0x85ebca6b;
+      bits ^= bits >> 13;
+      bits *= 0xc2b2ae35;
+      return bits ^ ( bits >> 16 );
+   }
+}
+
+void karma_rank_tree::rotate_left( unique_ptr<node>& n )
+{
+   unique_ptr<node> r = std::move( n->right );
+   n->right = std::move( r->left );
+   update( *n );
+   r->left = std::move( n );
+   n = std::move( r );
+   update( *n );
+}
+
+void karma_rank_tree::rotate_right( unique_ptr<node>& n )
+{
+   unique_ptr<node> l = std::move( n->left );
+   n->left = std::move( l->right );
+   update( *n );
+   l->right = std::move( n );
+   n = std::move( l );
+   update( *n );
+}
+
+void karma_rank_tree::adjust( unique_ptr<node>& n, float karma, bool increment )
+{
+   if( !n )
+   {
+      assert( increment );
+      n.reset( new node{ karma, karma_priority( karma ), 1, 1, nullptr, nullptr } );
+      return;
+   }
+   if( karma < n->karma )
+   {
+      adjust( n->left, karma, increment );
+      if( n->left && n->left->priority > n->priority )
+         rotate_right( n );
+   }
+   else if( n->karma < karma )
+   {
+      adjust( n->right, karma, increment );
+      if( n->right && n->right->priority > n->priority )
+         rotate_left( n );
+   }
+   else if( increment )
+      ++n->count;
+   else
+   {
+      assert( n->count > 0 );
+      if( --n->count == 0 )
+         return erase( n );
+   }
+   update( *n );
+}
+
+void karma_rank_tree::erase( unique_ptr<node>& n )
+{
+   // rotated down until it is a leaf
+   if( !n->left && !n->right )
+   {
+      n.reset();
+      return;
+   }
+   if( !n->right || ( n->left && n->left->priority > n->right->priority ) )
+   {
+      rotate_right( n );
+      erase( n->right );
+   }
+   else
+   {
+      rotate_left( n );
+      erase( n->left );
+   }
+   update( *n );
+}
+
+void karma_rank_tree::add( float karma )
+{
+   adjust( _root, normalized_karma( karma ), true );
+}
+
+void karma_rank_tree::sub( float karma )
+{
+   adjust( _root, normalized_karma( karma ), false );
+}
+
+uint32_t karma_rank_tree::count_above( float karma )const
+{
+   karma = normalized_karma( karma );
+   uint32_t count = 0;
+   const node* n = _root.get();
+   while( n != nullptr )
+   {
+      if( karma < n->karma )
+      {
+         count += n->count + total( n->right );
+         n = n->left.get();
+      }
+      else
+         n = n->right.get();
+   }
+   return count;
+}
+
+uint32_t karma_rank_tree::size()const
+{
+   return total( _root );
+}
+
+void account_karma_index::object_inserted( const object& obj )
+{
+    assert( dynamic_cast<const account_object*>(&obj) ); // for debug only
+    accounts_by_karma.add( static_cast<const account_object&>(obj).karma );
+}
+
+void account_karma_index::object_removed( const object& obj )
+{
+    assert( dynamic_cast<const account_object*>(&obj) ); // for debug only
+    accounts_by_karma.sub( static_cast<const account_object&>(obj).karma );
+}
+
+void account_karma_index::about_to_modify( const object& before )
+{
+    assert( dynamic_cast<const account_object*>(&before) ); // for debug only
+    before_karma = static_cast<const account_object&>(before).karma;
+}
+
+void account_karma_index::object_modified( const object& after )
+{
+    assert( dynamic_cast<const account_object*>(&after) ); // for debug only
+    float karma = static_cast<const account_object&>(after).karma;
+    if( karma != before_karma )
+    {
+        accounts_by_karma.sub( before_karma );
+        accounts_by_karma.add( karma );
+    }
+}
+
+uint32_t account_karma_index::count_above( float karma )const
+{
+    return accounts_by_karma.count_above( karma );
+}
+
+std::string karma_change_reason_text( karma_change_reason reason )
+{
+    switch( reason )
+    {
+        case karma_account_created:         return "Account created.";
+        case karma_monthly_payment_settled: return "Settle monthly payment complete normal.";
+        case karma_monthly_payment_delayed: return "Settle monthly payment complete ubnormal: insufficient balance.";
+        case karma_credit_completed:        return "Credit complete normal.";
+        case karma_credit_defaulted:        return "Credit complete ubnormal.";
+        case karma_credit_completed_forced: return "Credit complete forced.";
+    }
+    return std::string();
+}
+
+void add_karma_history_entry(graphene::chain::database& db, account_id_type account_id, float amount, karma_change_reason reason)
+{
+    // the next sequence follows the newest entry of the account
+    const auto& entries = db.get_index_type<karma_history_entry_index>().indices().get<by_account_seq>();
+    uint32_t sequence = 0;
+    auto itr = entries.upper_bound( boost::make_tuple( account_id ) );
+    if( itr != entries.begin() && (--itr)->account == account_id )
+        sequence = itr->sequence + 1;
+
+    db.create<karma_history_entry_object>([&](karma_history_entry_object& entry) {
+        entry.account = account_id;
+        entry.sequence = sequence;
+        entry.date = db.head_block_time();
+        entry.amount = amount;
+        entry.reason = reason;
+    });
+}
+
+void update_account_karma(graphene::chain::database* db, account_id_type account_id, float amount, karma_change_reason reason)
 {
     db->modify(account_id( *db ), [amount](account_object& account) {
         account.update_karma(amount);
     });
 
-    auto& account_history_of_karma_objs = db->get_index_type<account_history_of_karma_index>().indices().get<by_id>();
-    for (auto itr = account_history_of_karma_objs.begin( ); itr != account_history_of_karma_objs.end( ); itr++ )
-    {
-        if(account_id == (*itr).account)
-        {
-            account_history_of_karma_id_type obj_history_id = (*itr).id;
-            db->modify(obj_history_id( *db ), [&](account_history_of_karma_object& history) {
-               history.add_history_entry(db->head_block_time(), amount, info);
-            });
-        }    
-    }
+    const auto& account_history_of_karma_objs = db->get_index_type<account_history_of_karma_index>().indices().get<by_account>();
+    if( account_history_of_karma_objs.find( account_id ) != account_history_of_karma_objs.end() )
+        add_karma_history_entry( *db, account_id, amount, reason );
 }
 
 } } // graphene::chain
@@ -161,6 +161,12 @@ string asset_object::amount_to_string(share_type amount) const
 
  double asset_object::amount_to_real(share_type amount)const
  {
+     // Both operands are exact, so the quotient is rounded once to the nearest double, which is what
+     // parsing the decimal text of the amount gives. Negative amounts keep the text round trip, whose
+     // text is not the decimal value of the amount.
+     if( amount.value >= 0 && amount.value <= ( int64_t(1) << 53 ) )
+        return double( amount.value ) / asset::real_scaled_precision( precision );
+
      std::stringstream ss( amount_to_string( amount ) );
      double r;
      ss >> r;
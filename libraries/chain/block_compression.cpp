@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/chain/block_compression.hpp>
+#include <fc/exception/exception.hpp>
+
+#include <cstdint>
+#include <cstring>
+
+namespace graphene { namespace chain {
+
+namespace {
+   const size_t min_match    = 4;
+   const size_t max_distance = 0xffff;
+   const size_t hash_bits    = 14;
+
+   uint32_t read32( const char* p )
+   {
+      uint32_t v;
+      memcpy( &v, p, sizeof(v) );
+      return v;
+   }
+
+   size_t hash4( const char* p )
+   {
+      return ( read32( p ) * 2654435761u ) >> ( 32 - hash_bits );
+   }
+
+   void put_varint( std::vector<char>& out, size_t v )
+   {
+      while( v >= 0x80 )
+      {
+         out.push_back( char( v | 0x80 ) );
+         v >>= 7;
+      }
+      out.push_back( char( v ) );
+   }
+
+   size_t get_varint( const char*& p, const char* end )
+   {
+      size_t v = 0;
+      for( unsigned shift = 0; ; shift += 7 )
+      {
+         FC_ASSERT( p < end && shift < 64, "Malformed compressed chunk" );
+         uint8_t b = uint8_t( *p++ );
+         v |= size_t( b & 0x7f ) << shift;
+         if( !( b & 0x80 ) )
+            return v;
+      }
+   }
+
+   void put_literals( std::vector<char>& out, const char* begin, const char* end )
+   {
+      put_varint( out, end - begin );
+      out.insert( out.end(), begin, end );
+   }
+}
+
+std::vector<char> compress_chunk( const char* data, size_t size )
+{
+   std::vector<char> out;
+   out.reserve( size / 2 + 16 );
+
+   std::vector<uint32_t> table( size_t(1) << hash_bits, uint32_t(-1) );
+   const char* end = data + size;
+   const char* literals = data;
+   const char* p = data;
+   while( size >= min_match && p <= end - min_match )
+   {
+      size_t h = hash4( p );
+      uint32_t candidate = table[h];
+      table[h] = uint32_t( p - data );
+      if( candidate == uint32_t(-1) || size_t( p - data ) - candidate > max_distance
+          || read32( data + candidate ) != read32( p ) )
+      {
+         ++p;
+         continue;
+      }
+
+      const char* match = data + candidate;
+      size_t length = min_match;
+      while( p + length < end && match[length] == p[length] )
+         ++length;
+
+      put_literals( out, literals, p );
+      put_varint( out, length - min_match );
+      size_t distance = p - match;
+      out.push_back( char( distance & 0xff ) );
+      out.push_back( char( distance >> 8 ) );
+
+      p += length;
+      literals = p;
+   }
+   put_literals( out, literals, end );
+   return out;
+}
+
+void decompress_chunk( const char* data, size_t size, char* out, size_t raw_size )
+{
+   const char* in = data;
+   const char* in_end = data + size;
+   size_t pos = 0;
+   while( true )
+   {
+      size_t literal_count = get_varint( in, in_end );
+      FC_ASSERT( literal_count <= size_t( in_end - in ) && literal_count <= raw_size - pos, "Malformed compressed chunk" );
+      if( literal_count > 0 )
+         memcpy( out + pos, in, literal_count );
+      in += literal_count;
+      pos += literal_count;
+      if( in == in_end )
+         break;
+
+      size_t length = get_varint( in, in_end ) + min_match;
+      FC_ASSERT( in_end - in >= 2, "Malformed compressed chunk" );
+      size_t distance = uint8_t( in[0] ) | ( size_t( uint8_t( in[1] ) ) << 8 );
+      in += 2;
+      FC_ASSERT( distance > 0 && distance <= pos && length <= raw_size - pos, "Malformed compressed chunk" );
+      // the match may overlap the bytes it produces
+      for( size_t i = 0; i < length; ++i, ++pos )
+         out[pos] = out[pos - distance];
+   }
+   FC_ASSERT( pos == raw_size, "Compressed chunk has the wrong size" );
+}
+
+} }
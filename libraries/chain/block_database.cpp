@@ -22,10 +22,25 @@
  * THE SOFTWARE.
  */
 #include <graphene/chain/block_database.hpp>
+#include <graphene/chain/block_compression.hpp>
 #include <graphene/chain/protocol/fee_schedule.hpp>
 #include <fc/io/raw.hpp>
 #include <fc/smart_ref_impl.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <limits>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
 namespace graphene { namespace chain {
 
 struct index_entry
@@ -33,46 +48,195 @@ struct index_entry
    uint64_t      block_pos = 0;
    uint32_t      block_size = 0;
    block_id_type block_id;
+
+   /// a block in a chunk has this bit set in block_pos, the chunk number above bit 32 and its offset in the
+   /// decompressed chunk below
+   static const uint64_t in_chunk = uint64_t(1) << 63;
+
+   bool     is_in_chunk()const  { return block_pos & in_chunk; }
+   uint32_t chunk_num()const    { return uint32_t( ( block_pos & ~in_chunk ) >> 32 ); }
+   uint32_t chunk_offset()const { return uint32_t( block_pos ); }
+};
+
+struct chunk_entry
+{
+   uint64_t      pos = 0;
+   uint32_t      compressed_size = 0;
+   uint32_t      raw_size = 0;
 };
  }}
 FC_REFLECT( graphene::chain::index_entry, (block_pos)(block_size)(block_id) );
 
 namespace graphene { namespace chain {
 
+namespace {
+#ifdef WIN32
+   int open_file( const fc::path& file, bool truncate )
+   {
+      return _wopen( file.wstring().c_str(), _O_BINARY | _O_RDWR | _O_CREAT | ( truncate ? _O_TRUNC : 0 ), _S_IREAD | _S_IWRITE );
+   }
+
+   void close_file( int fd ) { _close( fd ); }
+
+   uint64_t file_size( int fd )
+   {
+      struct _stat64 st;
+      FC_ASSERT( _fstat64( fd, &st ) == 0 );
+      return st.st_size;
+   }
+
+   /// reads at @p pos without using the file position, so it can run on any number of threads at once
+   size_t read_at( int fd, char* data, size_t size, uint64_t pos )
+   {
+      OVERLAPPED at = {};
+      at.Offset = DWORD( pos );
+      at.OffsetHigh = DWORD( pos >> 32 );
+      DWORD done = 0;
+      if( !ReadFile( (HANDLE)_get_osfhandle( fd ), data, DWORD( size ), &done, &at ) )
+         return 0;
+      return done;
+   }
+
+   void write_at( int fd, const char* data, size_t size, uint64_t pos )
+   {
+      OVERLAPPED at = {};
+      at.Offset = DWORD( pos );
+      at.OffsetHigh = DWORD( pos >> 32 );
+      DWORD done = 0;
+      FC_ASSERT( WriteFile( (HANDLE)_get_osfhandle( fd ), data, DWORD( size ), &done, &at ) && done == size );
+   }
+
+   void truncate_file( int fd, uint64_t size ) { FC_ASSERT( _chsize_s( fd, size ) == 0 ); }
+#else
+   int open_file( const fc::path& file, bool truncate )
+   {
+      return ::open( file.generic_string().c_str(), O_RDWR | O_CREAT | ( truncate ? O_TRUNC : 0 ), 0644 );
+   }
+
+   void close_file( int fd ) { ::close( fd ); }
+
+   uint64_t file_size( int fd )
+   {
+      struct stat st;
+      FC_ASSERT( ::fstat( fd, &st ) == 0 );
+      return st.st_size;
+   }
+
+   /// reads at @p pos without using the file position, so it can run on any number of threads at once
+   size_t read_at( int fd, char* data, size_t size, uint64_t pos )
+   {
+      size_t done = 0;
+      while( done < size )
+      {
+         ssize_t n = ::pread( fd, data + done, size - done, pos + done );
+         if( n < 0 && errno == EINTR )
+            continue;
+         if( n <= 0 )
+            break;
+         done += n;
+      }
+      return done;
+   }
+
+   void write_at( int fd, const char* data, size_t size, uint64_t pos )
+   {
+      size_t done = 0;
+      while( done < size )
+      {
+         ssize_t n = ::pwrite( fd, data + done, size - done, pos + done );
+         if( n < 0 && errno == EINTR )
+            continue;
+         FC_ASSERT( n > 0, "Unable to write to the block database", ("errno",errno) );
+         done += n;
+      }
+   }
+
+   void truncate_file( int fd, uint64_t size ) { FC_ASSERT( ::ftruncate( fd, size ) == 0 ); }
+#endif
+
+   /// one buffer per thread for the packed blocks, so fetching does not allocate once it has grown
+   vector<char>& read_buffer( size_t size )
+   {
+      static thread_local vector<char> buffer;
+      if( buffer.size() < size )
+         buffer.resize( size );
+      return buffer;
+   }
+
+   /// the last chunk decompressed by a thread, replay reads all blocks of a chunk one after another
+   struct chunk_cache
+   {
+      uint64_t      tag = 0;
+      uint32_t      chunk_num = 0;
+      vector<char>  data;
+   };
+
+   std::atomic<uint64_t> next_chunk_cache_tag( 1 );
+}
+
+block_database::~block_database()
+{
+   close();
+}
+
 void block_database::open( const fc::path& dbdir )
 { try {
    fc::create_directories(dbdir);
-   _block_num_to_pos.exceptions(std::ios_base::failbit | std::ios_base::badbit);
-   _blocks.exceptions(std::ios_base::failbit | std::ios_base::badbit);
 
    _index_filename = dbdir / "index";
-   if( !fc::exists( _index_filename ) )
+   bool create = !fc::exists( _index_filename );
+   _block_num_to_pos = open_file( _index_filename, create );
+   FC_ASSERT( _block_num_to_pos >= 0, "Unable to open ${f}", ("f",_index_filename) );
+   _blocks = open_file( dbdir / "blocks", create );
+   FC_ASSERT( _blocks >= 0, "Unable to open ${f}", ("f",dbdir / "blocks") );
+   _blocks_size = file_size( _blocks );
+
+   _chunks_filename = dbdir / "chunks";
+   _chunk_index_filename = dbdir / "chunk_index";
+   _chunk_cache_tag = next_chunk_cache_tag++;
+   if( !create && fc::exists( _chunk_index_filename ) )
    {
-     _block_num_to_pos.open( _index_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
-     _blocks.open( (dbdir/"blocks").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
+      _chunk_index = open_file( _chunk_index_filename, false );
+      FC_ASSERT( _chunk_index >= 0, "Unable to open ${f}", ("f",_chunk_index_filename) );
+      _chunks = open_file( _chunks_filename, false );
+      FC_ASSERT( _chunks >= 0, "Unable to open ${f}", ("f",_chunks_filename) );
+      _chunk_count = file_size( _chunk_index ) / sizeof( chunk_entry );
+      _chunks_size = file_size( _chunks );
    }
    else
    {
-     _block_num_to_pos.open( _index_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
-     _blocks.open( (dbdir/"blocks").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
+      fc::remove_all( _chunk_index_filename );
+      fc::remove_all( _chunks_filename );
    }
 } FC_CAPTURE_AND_RETHROW( (dbdir) ) }
 
 bool block_database::is_open()const
 {
-  return _blocks.is_open();
+  return _blocks >= 0;
 }
 
 void block_database::close()
 {
-  _blocks.close();
-  _block_num_to_pos.close();
+  if( _blocks >= 0 )
+     close_file( _blocks );
+  if( _block_num_to_pos >= 0 )
+     close_file( _block_num_to_pos );
+  if( _chunks >= 0 )
+     close_file( _chunks );
+  if( _chunk_index >= 0 )
+     close_file( _chunk_index );
+  _blocks = -1;
+  _block_num_to_pos = -1;
+  _blocks_size = 0;
+  _chunks = -1;
+  _chunk_index = -1;
+  _chunks_size = 0;
+  _chunk_count = 0;
 }
 
 void block_database::flush()
 {
-  _blocks.flush();
-  _block_num_to_pos.flush();
+  // the writes are not buffered in the process
 }
 
 void block_database::store( const block_id_type& _id, const signed_block& b )
@@ -83,90 +247,150 @@ void block_database::store( const block_id_type& _id, const signed_block& b )
       id = b.id();
       elog( "id argument of block_database::store() was not initialized for block ${id}", ("id", id) );
    }
-   _block_num_to_pos.seekp( sizeof( index_entry ) * int64_t(block_header::num_from_id(id)) );
    index_entry e;
-   _blocks.seekp( 0, _blocks.end );
    auto vec = fc::raw::pack( b );
-   e.block_pos  = _blocks.tellp();
+   e.block_pos  = _blocks_size;
    e.block_size = vec.size();
    e.block_id   = id;
-   _blocks.write( vec.data(), vec.size() );
-   _block_num_to_pos.write( (char*)&e, sizeof(e) );
+   write_at( _blocks, vec.data(), vec.size(), e.block_pos );
+   _blocks_size += vec.size();
+   write_at( _block_num_to_pos, (const char*)&e, sizeof(e), sizeof( index_entry ) * uint64_t(block_header::num_from_id(id)) );
 }
 
+void block_database::store_chunk( const vector<signed_block>& blocks )
+{ try {
+   if( blocks.empty() )
+      return;
+   if( _chunk_index < 0 )
+   {
+      _chunk_index = open_file( _chunk_index_filename, true );
+      FC_ASSERT( _chunk_index >= 0, "Unable to create ${f}", ("f",_chunk_index_filename) );
+      _chunks = open_file( _chunks_filename, true );
+      FC_ASSERT( _chunks >= 0, "Unable to create ${f}", ("f",_chunks_filename) );
+   }
+
+   vector<char> raw;
+   vector<index_entry> entries;
+   entries.reserve( blocks.size() );
+   for( const signed_block& b : blocks )
+   {
+      FC_ASSERT( entries.empty() || b.previous == entries.back().block_id, "The blocks of a chunk have to follow each other" );
+      index_entry e;
+      e.block_pos  = index_entry::in_chunk | ( uint64_t(_chunk_count) << 32 ) | raw.size();
+      auto vec = fc::raw::pack( b );
+      e.block_size = vec.size();
+      e.block_id   = b.id();
+      raw.insert( raw.end(), vec.begin(), vec.end() );
+      FC_ASSERT( raw.size() <= std::numeric_limits<uint32_t>::max(), "Chunk too large" );
+      entries.push_back( e );
+   }
+
+   vector<char> compressed = compress_chunk( raw.data(), raw.size() );
+   chunk_entry c;
+   c.pos = _chunks_size;
+   c.compressed_size = compressed.size();
+   c.raw_size = raw.size();
+   write_at( _chunks, compressed.data(), compressed.size(), c.pos );
+   _chunks_size += compressed.size();
+   write_at( _chunk_index, (const char*)&c, sizeof(c), sizeof( chunk_entry ) * uint64_t(_chunk_count) );
+   ++_chunk_count;
+
+   // the index entries go last, a chunk is not used before all of it is on disk
+   for( const index_entry& e : entries )
+      write_at( _block_num_to_pos, (const char*)&e, sizeof(e), sizeof( index_entry ) * uint64_t(block_header::num_from_id(e.block_id)) );
+} FC_CAPTURE_AND_RETHROW( (blocks.size()) ) }
+
 void block_database::remove( const block_id_type& id )
 { try {
-   index_entry e;
-   int64_t index_pos = sizeof(e) * int64_t(block_header::num_from_id(id));
-   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() <= index_pos )
+   optional<index_entry> e = read_index_entry( block_header::num_from_id(id) );
+   if( !e.valid() )
       FC_THROW_EXCEPTION(fc::key_not_found_exception, "Block ${id} not contained in block database", ("id", id));
 
-   _block_num_to_pos.seekg( index_pos );
-   _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
-   if( e.block_id == id )
+   if( e->block_id == id )
    {
-      e.block_size = 0;
-      _block_num_to_pos.seekp( sizeof(e) * int64_t(block_header::num_from_id(id)) );
-      _block_num_to_pos.write( (char*)&e, sizeof(e) );
+      e->block_size = 0;
+      write_at( _block_num_to_pos, (const char*)&*e, sizeof(index_entry), sizeof( index_entry ) * uint64_t(block_header::num_from_id(id)) );
    }
 } FC_CAPTURE_AND_RETHROW( (id) ) }
 
+optional<index_entry> block_database::read_index_entry( uint32_t block_num )const
+{
+   index_entry e;
+   if( read_at( _block_num_to_pos, (char*)&e, sizeof(e), sizeof(e) * uint64_t(block_num) ) != sizeof(e) )
+      return optional<index_entry>();
+   return e;
+}
+
+const vector<char>& block_database::read_chunk( uint32_t chunk_num )const
+{
+   static thread_local chunk_cache cache;
+   if( cache.tag == _chunk_cache_tag && cache.chunk_num == chunk_num )
+      return cache.data;
+
+   FC_ASSERT( chunk_num < _chunk_count, "No chunk ${n} in the block database", ("n",chunk_num) );
+   chunk_entry c;
+   FC_ASSERT( read_at( _chunk_index, (char*)&c, sizeof(c), sizeof(c) * uint64_t(chunk_num) ) == sizeof(c) );
+   vector<char>& compressed = read_buffer( c.compressed_size );
+   FC_ASSERT( read_at( _chunks, compressed.data(), c.compressed_size, c.pos ) == c.compressed_size );
+
+   cache.tag = 0;
+   cache.data.resize( c.raw_size );
+   decompress_chunk( compressed.data(), c.compressed_size, cache.data.data(), c.raw_size );
+   cache.tag = _chunk_cache_tag;
+   cache.chunk_num = chunk_num;
+   return cache.data;
+}
+
+optional<signed_block> block_database::read_block( const index_entry& e )const
+{
+   const char* packed;
+   if( e.is_in_chunk() )
+   {
+      const vector<char>& chunk = read_chunk( e.chunk_num() );
+      FC_ASSERT( uint64_t(e.chunk_offset()) + e.block_size <= chunk.size() );
+      packed = chunk.data() + e.chunk_offset();
+   }
+   else
+   {
+      vector<char>& data = read_buffer( e.block_size );
+      if( read_at( _blocks, data.data(), e.block_size, e.block_pos ) != e.block_size )
+         return optional<signed_block>();
+      packed = data.data();
+   }
+   fc::datastream<const char*> ds( packed, e.block_size );
+   signed_block result;
+   fc::raw::unpack( ds, result );
+   FC_ASSERT( result.id() == e.block_id );
+   return result;
+}
+
 bool block_database::contains( const block_id_type& id )const
 {
    if( id == block_id_type() )
       return false;
 
-   index_entry e;
-   int64_t index_pos = sizeof(e) * int64_t(block_header::num_from_id(id));
-   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() < int64_t(index_pos + sizeof(e)) )
-      return false;
-   _block_num_to_pos.seekg( index_pos );
-   _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
-   return e.block_id == id && e.block_size > 0;
+   optional<index_entry> e = read_index_entry( block_header::num_from_id(id) );
+   return e.valid() && e->block_id == id && e->block_size > 0;
 }
 
 block_id_type block_database::fetch_block_id( uint32_t block_num )const
 {
    assert( block_num != 0 );
-   index_entry e;
-   int64_t index_pos = sizeof(e) * int64_t(block_num);
-   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() <= index_pos )
+   optional<index_entry> e = read_index_entry( block_num );
+   if( !e.valid() )
       FC_THROW_EXCEPTION(fc::key_not_found_exception, "Block number ${block_num} not contained in block database", ("block_num", block_num));
 
-   _block_num_to_pos.seekg( index_pos );
-   _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
-   FC_ASSERT( e.block_id != block_id_type(), "Empty block_id in block_database (maybe corrupt on disk?)" );
-   return e.block_id;
+   FC_ASSERT( e->block_id != block_id_type(), "Empty block_id in block_database (maybe corrupt on disk?)" );
+   return e->block_id;
 }
 
 optional<signed_block> block_database::fetch_optional( const block_id_type& id )const
 {
    try
    {
-      index_entry e;
-      int64_t index_pos = sizeof(e) * int64_t(block_header::num_from_id(id));
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-      if ( _block_num_to_pos.tellg() <= index_pos )
-         return {};
-
-      _block_num_to_pos.seekg( index_pos );
-      _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
-      if( e.block_id != id ) return optional<signed_block>();
-
-      vector<char> data( e.block_size );
-      _blocks.seekg( e.block_pos );
-      if (e.block_size)
-         _blocks.read( data.data(), e.block_size );
-      auto result = fc::raw::unpack<signed_block>(data);
-      FC_ASSERT( result.id() == e.block_id );
-      return result;
+      optional<index_entry> e = read_index_entry( block_header::num_from_id(id) );
+      if( !e.valid() || e->block_id != id ) return optional<signed_block>();
+      return read_block( *e );
    }
    catch (const fc::exception&)
    {
@@ -181,21 +405,51 @@ optional<signed_block> block_database::fetch_by_number( uint32_t block_num )cons
 {
    try
    {
-      index_entry e;
-      int64_t index_pos = sizeof(e) * int64_t(block_num);
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-      if ( _block_num_to_pos.tellg() <= index_pos )
-         return {};
+      optional<index_entry> e = read_index_entry( block_num );
+      if( !e.valid() ) return optional<signed_block>();
+      return read_block( *e );
+   }
+   catch (const fc::exception&)
+   {
+   }
+   catch (const std::exception&)
+   {
+   }
+   return optional<signed_block>();
+}
 
-      _block_num_to_pos.seekg( index_pos, _block_num_to_pos.beg );
-      _block_num_to_pos.read( (char*)&e, sizeof(e) );
+bool block_database::check_entry( const index_entry& e )const
+{
+   if( e.block_size == 0 )
+      return false;
+   if( e.is_in_chunk() )
+   {
+      try
+      {
+         return e.chunk_num() < _chunk_count && read_block( e ).valid();
+      }
+      catch (const fc::exception&)
+      {
+      }
+      catch (const std::exception&)
+      {
+      }
+      return false;
+   }
+   if( e.block_pos + e.block_size > _blocks_size )
+      return false;
 
-      vector<char> data( e.block_size );
-      _blocks.seekg( e.block_pos );
-      _blocks.read( data.data(), e.block_size );
-      auto result = fc::raw::unpack<signed_block>(data);
-      FC_ASSERT( result.id() == e.block_id );
-      return result;
+   // the id is the hash of the signed header, which the packed block starts with
+   const size_t header_size = std::min<size_t>( e.block_size, 512 );
+   vector<char>& data = read_buffer( header_size );
+   if( read_at( _blocks, data.data(), header_size, e.block_pos ) != header_size )
+      return false;
+   try
+   {
+      fc::datastream<const char*> ds( data.data(), header_size );
+      signed_block_header header;
+      fc::raw::unpack( ds, header );
+      return header.id() == e.block_id;
    }
    catch (const fc::exception&)
    {
@@ -203,49 +457,34 @@ optional<signed_block> block_database::fetch_by_number( uint32_t block_num )cons
    catch (const std::exception&)
    {
    }
-   return optional<signed_block>();
+   // a header with large extensions, read the whole block
+   try
+   {
+      return read_block( e ).valid();
+   }
+   catch (const fc::exception&)
+   {
+   }
+   catch (const std::exception&)
+   {
+   }
+   return false;
 }
 
 optional<index_entry> block_database::last_index_entry()const {
    try
    {
-      index_entry e;
-
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-      std::streampos pos = _block_num_to_pos.tellg();
-      if( pos < long(sizeof(index_entry)) )
-         return optional<index_entry>();
-
+      uint64_t pos = file_size( _block_num_to_pos );
       pos -= pos % sizeof(index_entry);
 
-      _blocks.seekg( 0, _block_num_to_pos.end );
-      const std::streampos blocks_size = _blocks.tellg();
+      // normally the last entry is valid, entries written after the blocks were lost are dropped
       while( pos > 0 )
       {
          pos -= sizeof(index_entry);
-         _block_num_to_pos.seekg( pos );
-         _block_num_to_pos.read( (char*)&e, sizeof(e) );
-         if( _block_num_to_pos.gcount() == sizeof(e) && e.block_size > 0
-                && int64_t(e.block_pos + e.block_size) <= blocks_size )
-            try
-            {
-               vector<char> data( e.block_size );
-               _blocks.seekg( e.block_pos );
-               _blocks.read( data.data(), e.block_size );
-               if( _blocks.gcount() == long(e.block_size) )
-               {
-                  const signed_block block = fc::raw::unpack<signed_block>(data);
-                  if( block.id() == e.block_id )
-                     return e;
-               }
-            }
-            catch (const fc::exception&)
-            {
-            }
-            catch (const std::exception&)
-            {
-            }
-         fc::resize_file( _index_filename, pos );
+         index_entry e;
+         if( read_at( _block_num_to_pos, (char*)&e, sizeof(e), pos ) == sizeof(e) && check_entry( e ) )
+            return e;
+         truncate_file( _block_num_to_pos, pos );
       }
    }
    catch (const fc::exception&)
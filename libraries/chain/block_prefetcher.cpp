@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/chain/block_prefetcher.hpp>
+#include <graphene/chain/block_database.hpp>
+
+#include <algorithm>
+
+namespace graphene { namespace chain {
+
+const uint32_t block_prefetcher::run_size;
+
+block_prefetcher::block_prefetcher( const block_database& blocks, uint32_t first_block_num, uint32_t last_block_num,
+                                    const chain_id_type& chain_id, bool recover_signatures,
+                                    uint32_t thread_count, uint32_t window )
+   : _blocks( blocks ), _last_block_num( last_block_num ), _window( std::max( window, run_size ) ),
+     _chain_id( chain_id ), _recover_signatures( recover_signatures ),
+     _slots( _window ), _next_to_fetch( first_block_num ), _next_to_take( first_block_num )
+{
+   if( thread_count == 0 )
+      thread_count = std::min( 4u, std::max( 2u, std::thread::hardware_concurrency() ) - 1 );
+   for( uint32_t i = 0; i < thread_count; ++i )
+      _threads.emplace_back( [this]() { work(); } );
+}
+
+block_prefetcher::~block_prefetcher()
+{
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      _stopping = true;
+   }
+   _taken.notify_all();
+   for( auto& thread : _threads )
+      thread.join();
+}
+
+void block_prefetcher::work()
+{
+   std::unique_lock<std::mutex> lock( _mutex );
+   while( true )
+   {
+      _taken.wait( lock, [this]() {
+         return _stopping || _next_to_fetch > _last_block_num || _next_to_fetch + run_size <= _next_to_take + _window;
+      });
+      if( _stopping || _next_to_fetch > _last_block_num )
+         return;
+
+      uint32_t first = _next_to_fetch;
+      uint32_t last = std::min( _last_block_num, first + run_size - 1 );
+      _next_to_fetch = last + 1;
+      lock.unlock();
+
+      vector<slot> run( last - first + 1 );
+      for( uint32_t i = 0; i < run.size(); ++i )
+      {
+         slot& s = run[i];
+         s.ready = true;
+         try {
+            optional<signed_block> block = _blocks.fetch_by_number( first + i );
+            if( block.valid() )
+            {
+               s.block = prefetched_block();
+               s.block->merkle_checked = block->transaction_merkle_root == block->calculate_merkle_root();
+               for( const auto& trx : block->transactions )
+                  trx.precompute_digests( _chain_id );
+               if( _recover_signatures )
+               {
+                  s.block->signature_keys.reserve( block->transactions.size() );
+                  for( const auto& trx : block->transactions )
+                     s.block->signature_keys.push_back( recovered_signature_keys::of( trx, _chain_id ) );
+               }
+               s.block->block = std::move( *block );
+            }
+         } catch( ... ) {
+            s.error = std::current_exception();
+         }
+      }
+
+      lock.lock();
+      for( uint32_t i = 0; i < run.size(); ++i )
+         _slots[ ( first + i ) % _window ] = std::move( run[i] );
+      _ready.notify_all();
+   }
+}
+
+optional<block_prefetcher::prefetched_block> block_prefetcher::next()
+{
+   std::unique_lock<std::mutex> lock( _mutex );
+   if( _next_to_take > _last_block_num )
+      return optional<prefetched_block>();
+
+   slot& s = _slots[ _next_to_take % _window ];
+   _ready.wait( lock, [&s]() { return s.ready; } );
+   slot result = std::move( s );
+   s = slot();
+   ++_next_to_take;
+   lock.unlock();
+   _taken.notify_all();
+
+   if( result.error )
+      std::rethrow_exception( result.error );
+   return result.block;
+}
+
+} }
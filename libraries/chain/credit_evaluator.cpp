@@ -24,13 +24,12 @@
 #include <graphene/chain/credit_evaluator.hpp>
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/credit_object.hpp>
+#include <graphene/chain/credit_money.hpp>
+#include <graphene/chain/credit_statistics_object.hpp>
 #include <graphene/chain/exchange_rate_object.hpp>
 #include <graphene/chain/exceptions.hpp>
 #include <graphene/chain/hardfork.hpp>
 #include <graphene/chain/is_authorized_asset.hpp>
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/json_parser.hpp>
-#include <boost/algorithm/string.hpp>
 #include <graphene/chain/exchange_rate_object.hpp>
 
 #include <iostream>
@@ -63,11 +62,11 @@ void_result credit_request_evaluator::do_evaluate( const credit_request_operatio
 
       if( deposit.amount_to_real( op.deposit_asset.amount ) != 0.0 )
       {
-            double deposit_exchange_rate = get_exchange_rate_by_symbol(&d, deposit.symbol);
+            double deposit_exchange_rate = get_exchange_rate(d, deposit);
             deposit_in_core = deposit.amount_to_real( op.deposit_asset.amount ) * deposit_exchange_rate;
       }
 
-      double loan_exchange_rate = get_exchange_rate_by_symbol(&d, loan.symbol);
+      double loan_exchange_rate = get_exchange_rate(d, loan);
       double loan_in_core = loan.amount_to_real( op.loan_asset.amount ) * loan_exchange_rate;  
 
       if( op.loan_period == 0 )
@@ -92,10 +91,8 @@ void_result credit_request_evaluator::do_evaluate( const credit_request_operatio
 
       if( db().head_block_time() >= HARDFORK_CORE_KARMA_2_TIME )
       {
-            const auto& idx = db().get_index_type<account_index>().indices().get<by_name>();
-            std::string special_account_name = db().get_global_properties().parameters.get_bonus_options().special_account_name;
-            auto itr_account_obj = idx.find(special_account_name);
-            FC_ASSERT( itr_account_obj != idx.end(), "No special account found: ${a}.",("a", special_account_name));
+            FC_ASSERT( db().find_special_account() != nullptr, "No special account found: ${a}.",
+                       ("a", db().get_bonus_options().special_account_name));
       }
 
       return void_result();      
@@ -132,33 +129,14 @@ object_id_type credit_request_evaluator::do_apply( const credit_request_operatio
          boost::uuids::string_generator gen;
          boost::uuids::uuid u1 = gen( id + time_str + time_str );
          obj.object_uuid = to_string(u1);
+         memcpy( obj.uuid_key.data, u1.data, sizeof( obj.uuid_key.data ) );
          
-         const account_object& borrower_account = o.borrower( db( ) );
-         std::stringstream ss;
-         std::string time_json = db( ).head_block_time( ).to_iso_string( );
-         ss << time_json << " : " << "was created with id = " << obj.object_uuid << " by - " << borrower_account.name;
-         obj.history.push_back( ss.str( ) );
-
-         boost::property_tree::ptree root, details;
-         std::stringstream ss_json;
-         
-         if(obj.history_json.size())
-         {
-            ss_json << obj.history_json;
-            boost::property_tree::read_json(ss_json, root);
-            ss_json.str( std::string() );
-            ss_json.clear();
-         }   
-         details.put("type","request_creation");
-         details.put("id",obj.object_uuid);
-         details.put("borrower",borrower_account.name);
-         root.add_child(time_json, details);
-         
-         boost::property_tree::write_json(ss_json, root);
-         obj.history_json = ss_json.str();
-         obj.history_json.erase(std::remove(obj.history_json.begin(), obj.history_json.end(), '\n'), obj.history_json.end());
-         obj.history_json.erase(std::remove(obj.history_json.begin(), obj.history_json.end(), ' '), obj.history_json.end());
+         credit_created_event e;
+         e.uuid = obj.object_uuid;
+         e.borrower = o.borrower;
+         obj.add_history_event( db( ).head_block_time( ), std::move( e ) );
       });
+      update_credit_statistics( db( ), nullptr, &new_credit_object );
       // deposit money         
       db( ).adjust_balance( o.borrower, -o.deposit_asset );
    return new_credit_object.id;
@@ -177,104 +155,75 @@ object_id_type credit_approve_evaluator::do_apply( const credit_approve_operatio
 { 
    try {          
    object_id_type ret;
-   bool credit_request_founded = false;
-   auto& e = db( ).get_index_type<credit_index>( ).indices( ).get<by_uuid>( );
-
-   for( auto itr = e.begin( ); itr != e.end( ); itr++ )
-   {       
-      if( ( *itr ).object_uuid.compare( o.credit_request_uuid ) == 0 )
-      {
-            if( ( *itr ).status != e_credit_object_status::wating_for_acceptance )
-                  FC_ASSERT( 0, "credit request allready accepted!" );
-
-            const account_object& creditor_account = o.creditor( db( ) );
-            const asset_object& loan_asset_type = ( *itr ).borrower.loan_asset.asset_id( db( ) );  
-
-            bool insufficient_balance = db( ).get_balance( creditor_account, loan_asset_type ).amount >= ( *itr ).borrower.loan_asset.amount;
-            FC_ASSERT( insufficient_balance, "Insufficient Balance" );
-   
-            db( ).modify( *itr, [this,&o,&ret]( credit_object& b ) 
-            {
-                  b.creditor.creditor = o.creditor;
-                  b.creditor.credit_memo = o.credit_memo;
-            
-                  const asset_object& loan_asset_type = b.borrower.loan_asset.asset_id( db( ) );    
-                  b.creditor.monthly_payment = b.calculate_monthly_payment( loan_asset_type.amount_to_real( b.borrower.loan_asset.amount ), ( double )b.borrower.loan_persent, b.borrower.loan_period );
-
-                  b.request_approvation_time = db( ).head_block_time( );
-                  b.settle_month_elapsed = 0;
-                  b.status = e_credit_object_status::in_progress;
-
-                  const account_object& creditor_account = o.creditor( db( ) );
-                  std::stringstream ss;
-                  std::string time_json = db( ).head_block_time( ).to_iso_string( );
-                  std::string monthly_payment = std::to_string(b.creditor.monthly_payment);
-
-                  ss << time_json << " : " << "credit with id = " << b.object_uuid << " was accepted by - " << creditor_account.name << 
-                  " loan_amount = " << loan_asset_type.amount_to_string(b.borrower.loan_asset.amount) <<
-                  " loan_period_in_month = " << b.borrower.loan_period << " monthly_payment = " << monthly_payment ;
-                  b.history.push_back( ss.str( ) );
-
-                  boost::property_tree::ptree root, details;
-                  std::stringstream ss_json;
-
-                  if(b.history_json.size())
-                  {
-                        ss_json << b.history_json;
-                        boost::property_tree::read_json(ss_json, root);      
-                        ss_json.str( std::string() );
-                        ss_json.clear();
-                  }
-
-                  details.put("type","request_approved");
-                  details.put("id",b.object_uuid);
-                  details.put("creditor",creditor_account.name);
-                  details.put("loan_amount",loan_asset_type.amount_to_string(b.borrower.loan_asset.amount));
-                  details.put("loan_period_in_month",b.borrower.loan_period);
-                  details.put("monthly_payment",monthly_payment);
-                  root.add_child(time_json, details);
-                  
-                  boost::property_tree::write_json(ss_json, root);
-                  b.history_json = ss_json.str();
-                  b.history_json.erase(std::remove(b.history_json.begin(), b.history_json.end(), '\n'), b.history_json.end());
-                  b.history_json.erase(std::remove(b.history_json.begin(), b.history_json.end(), ' '), b.history_json.end());
-
-                  ret = b.id;            
-            });
-
-            db( ).adjust_balance( ( *itr ).creditor.creditor, -( *itr ).borrower.loan_asset );
-
-            // pay %bonus from credit sum to special karma account and referals
-            if( db().head_block_time() >= HARDFORK_CORE_KARMA_2_TIME )
-            {
-                  chain_parameters::ext::credit_referrer_bonus_options bo = db().get_global_properties().parameters.get_bonus_options();
-
-                  auto idx = db().get_index_type<account_index>().indices().get<by_name>().find(bo.special_account_name);
-                  account_id_type special_account_id = (*idx).get_id();
-
-                  double creditor_percent = (db().head_block_time() < ( *itr ).creditor.creditor(db()).credit_referrer_expiration_date) ? bo.creditor_referrer_bonus : 0;
-                  double borrower_percent = (db().head_block_time() < ( *itr ).borrower.borrower(db()).credit_referrer_expiration_date) ? bo.borrower_referrer_bonus : 0;
-                  double special_account_percent = bo.karma_account_bonus - borrower_percent - creditor_percent;
-
-                  asset asset_sum_for_creditor(( *itr ).borrower.loan_asset.amount.value * creditor_percent/100, loan_asset_type.get_id());
-                  asset asset_sum_for_borrower(( *itr ).borrower.loan_asset.amount.value * borrower_percent/100, loan_asset_type.get_id());
-                  asset asset_sum_to_special_account(( *itr ).borrower.loan_asset.amount.value * special_account_percent/100, loan_asset_type.get_id());
-
-                  db( ).adjust_balance( ( *itr ).creditor.creditor(db()).credit_referrer, asset_sum_for_creditor);
-                  db( ).adjust_balance( ( *itr ).borrower.borrower(db()).credit_referrer, asset_sum_for_borrower);   
-                  db( ).adjust_balance( special_account_id, asset_sum_to_special_account);   
-
-                  db( ).adjust_balance( ( *itr ).borrower.borrower, ( *itr ).borrower.loan_asset 
-                                                - asset_sum_for_creditor - asset_sum_for_borrower - asset_sum_to_special_account);   
-            }
-            else
-                db( ).adjust_balance( ( *itr ).borrower.borrower, ( *itr ).borrower.loan_asset );   
-                     
-            credit_request_founded = true;
-            break;
-      }
+   const credit_object* found = find_credit_by_uuid( db( ), o.credit_request_uuid );
+   FC_ASSERT( found != nullptr, "credit request not found!" );
+   const credit_object& credit = *found;
+
+   if( credit.status != e_credit_object_status::wating_for_acceptance )
+         FC_ASSERT( 0, "credit request allready accepted!" );
+
+   const account_object& creditor_account = o.creditor( db( ) );
+   const asset_object& loan_asset_type = credit.borrower.loan_asset.asset_id( db( ) );  
+
+   bool insufficient_balance = db( ).get_balance( creditor_account, loan_asset_type ).amount >= credit.borrower.loan_asset.amount;
+   FC_ASSERT( insufficient_balance, "Insufficient Balance" );
+
+   credit_statistics_state before( credit );
+   db( ).modify( credit, [this,&o,&ret]( credit_object& b ) 
+   {
+         b.creditor.creditor = o.creditor;
+         b.creditor.credit_memo = o.credit_memo;
+
+         const asset_object& loan_asset_type = b.borrower.loan_asset.asset_id( db( ) );    
+         b.creditor.monthly_payment = b.calculate_monthly_payment( loan_asset_type.amount_to_real( b.borrower.loan_asset.amount ), ( double )b.borrower.loan_persent, b.borrower.loan_period );
+
+         b.request_approvation_time = db( ).head_block_time( );
+         b.settle_month_elapsed = 0;
+         b.status = e_credit_object_status::in_progress;
+         // first deposit check happens on the block that accepts the credit
+         b.next_process_time = db( ).head_block_time( );
+
+         credit_approved_event e;
+         e.uuid = b.object_uuid;
+         e.creditor = o.creditor;
+         e.loan = b.borrower.loan_asset;
+         e.loan_period = b.borrower.loan_period;
+         e.monthly_payment = b.creditor.monthly_payment;
+         b.add_history_event( db( ).head_block_time( ), std::move( e ) );
+
+         ret = b.id;            
+   });
+   update_credit_statistics( db( ), &before, &credit );
+
+   db( ).adjust_balance( credit.creditor.creditor, -credit.borrower.loan_asset );
+
+   // pay %bonus from credit sum to special karma account and referals
+   if( db().head_block_time() >= HARDFORK_CORE_KARMA_2_TIME )
+   {
+         const chain_parameters::ext::credit_referrer_bonus_options& bo = db().get_bonus_options();
+
+         const account_object* special_account = db().find_special_account();
+         FC_ASSERT( special_account != nullptr, "No special account found: ${a}.", ("a", bo.special_account_name) );
+         account_id_type special_account_id = special_account->get_id();
+
+         double creditor_percent = (db().head_block_time() < credit.creditor.creditor(db()).credit_referrer_expiration_date) ? bo.creditor_referrer_bonus : 0;
+         double borrower_percent = (db().head_block_time() < credit.borrower.borrower(db()).credit_referrer_expiration_date) ? bo.borrower_referrer_bonus : 0;
+         double special_account_percent = bo.karma_account_bonus - borrower_percent - creditor_percent;
+
+         asset asset_sum_for_creditor(credit.borrower.loan_asset.amount.value * creditor_percent/100, loan_asset_type.get_id());
+         asset asset_sum_for_borrower(credit.borrower.loan_asset.amount.value * borrower_percent/100, loan_asset_type.get_id());
+         asset asset_sum_to_special_account(credit.borrower.loan_asset.amount.value * special_account_percent/100, loan_asset_type.get_id());
+
+         db( ).adjust_balance( credit.creditor.creditor(db()).credit_referrer, asset_sum_for_creditor);
+         db( ).adjust_balance( credit.borrower.borrower(db()).credit_referrer, asset_sum_for_borrower);   
+         db( ).adjust_balance( special_account_id, asset_sum_to_special_account);   
+
+         db( ).adjust_balance( credit.borrower.borrower, credit.borrower.loan_asset 
+                                       - asset_sum_for_creditor - asset_sum_for_borrower - asset_sum_to_special_account);   
    }
-   FC_ASSERT( credit_request_founded, "credit request not found!" );
+   else
+       db( ).adjust_balance( credit.borrower.borrower, credit.borrower.loan_asset );   
+
    return ret;
 } FC_CAPTURE_AND_RETHROW( ( o ) ) }
 
@@ -291,26 +240,20 @@ object_id_type credit_request_cancel_evaluator::do_apply( const credit_request_c
 { 
    try {          
    object_id_type ret;
-   bool credit_request_founded = false;
-   auto& e = db( ).get_index_type<credit_index>( ).indices( ).get<by_uuid>( );
+   const credit_object* found = find_credit_by_uuid( db( ), o.credit_request_uuid );
+   FC_ASSERT( found != nullptr, "credit request not found!" );
+   const credit_object& credit = *found;
 
-   for( auto itr = e.begin( ); itr != e.end( ); itr++ )
-   {       
-      if( ( *itr ).object_uuid.compare( o.credit_request_uuid ) == 0 )
-      {
-            if(o.borrower != ( *itr ).borrower.borrower)
-                  FC_ASSERT( 0, "Only owner can cancel the credit request!" );
-            
-            if( ( *itr ).status != e_credit_object_status::wating_for_acceptance )
-                  FC_ASSERT( 0, "credit request allready accepted!" );
-
-            db( ).adjust_balance( ( *itr ).borrower.borrower, ( *itr ).borrower.deposit_asset );
-            db( ).remove( *itr );
-            credit_request_founded = true;
-            break;
-      }
-   }
-   FC_ASSERT( credit_request_founded, "credit request not found!" );
+   if(o.borrower != credit.borrower.borrower)
+         FC_ASSERT( 0, "Only owner can cancel the credit request!" );
+
+   if( credit.status != e_credit_object_status::wating_for_acceptance )
+         FC_ASSERT( 0, "credit request allready accepted!" );
+
+   db( ).adjust_balance( credit.borrower.borrower, credit.borrower.deposit_asset );
+   credit_statistics_state before( credit );
+   update_credit_statistics( db( ), &before, nullptr );
+   db( ).remove( credit );
    return ret;
 } FC_CAPTURE_AND_RETHROW( ( o ) ) }
 
@@ -327,25 +270,17 @@ object_id_type comment_credit_request_evaluator::do_apply( const comment_credit_
 { 
    try {          
    object_id_type ret;
-   bool credit_request_founded = false;
-   auto& e = db( ).get_index_type<credit_index>( ).indices( ).get<by_uuid>( );
+   const credit_object* found = find_credit_by_uuid( db( ), o.credit_request_uuid );
+   FC_ASSERT( found != nullptr, "credit request not found!" );
+   const credit_object& credit = *found;
 
-   for( auto itr = e.begin( ); itr != e.end( ); itr++ )
-   {       
-      if( ( *itr ).object_uuid.compare( o.credit_request_uuid ) == 0 )
-      {
-            if( ( *itr ).status != e_credit_object_status::wating_for_acceptance )
-                  FC_ASSERT( 0, "credit request allready accepted!" );
-
-            db( ).modify( *itr, [this,&o,&ret]( credit_object& b ) 
-            {
-                  b.comments[o.credit_memo] = o.creditor;
-            });
-            credit_request_founded = true;
-            break;
-      }
-   }
-   FC_ASSERT( credit_request_founded, "credit request not found!" );
+   if( credit.status != e_credit_object_status::wating_for_acceptance )
+         FC_ASSERT( 0, "credit request allready accepted!" );
+
+   db( ).modify( credit, [this,&o,&ret]( credit_object& b ) 
+   {
+         b.comments[o.credit_memo] = o.creditor;
+   });
    return ret;
 } FC_CAPTURE_AND_RETHROW( ( o ) ) }
 
@@ -362,80 +297,52 @@ object_id_type settle_credit_operation_evaluator::do_apply( const settle_credit_
 { 
    try {          
    object_id_type ret;
-   bool credit_request_founded = false;
-   auto& e = db( ).get_index_type<credit_index>( ).indices( ).get<by_uuid>( );
+   const credit_object* found = find_credit_by_uuid( db( ), o.credit_request_uuid );
+   FC_ASSERT( found != nullptr, "credit request not found!" );
+   const credit_object& credit = *found;
+   database& d = db( );
+
+   const asset_object& loan = credit.borrower.loan_asset.asset_id( d );
+   const account_object& borrower_account = o.borrower( db( ) );
+   double settle_sum = 0.0;  
+
+   if( credit.status != e_credit_object_status::in_progress )
+         FC_ASSERT( 0, "credit request don't accepted!" );
+
+   if(o.borrower != credit.borrower.borrower)
+         FC_ASSERT( 0, "Only owner can settle the credit operation!" );
+
+   if( credit.settle_month_elapsed == 0 )
+         settle_sum = credit.borrower.loan_persent / 12.0 + loan.amount_to_real( credit.borrower.loan_asset.amount );
+   else
+         settle_sum = credit.creditor.monthly_payment * ( credit.borrower.loan_period - credit.settle_month_elapsed );   
+
+   asset settle = credit_money::from_real( loan, settle_sum ).to_asset( );
+
+   bool insufficient_balance = db( ).get_balance( borrower_account, loan ).amount >= settle.amount;
+   FC_ASSERT( insufficient_balance, "Insufficient Balance" );  
+
+   db( ).adjust_balance( credit.borrower.borrower, -settle );
+   db( ).adjust_balance( credit.creditor.creditor, settle );                   
+
+   credit_statistics_state before( credit );
+   db( ).modify( credit, [this,&o,&ret,&d]( credit_object& b ) 
+   {
+         const asset_object& deposit = b.borrower.deposit_asset.asset_id( d );
+         db( ).adjust_balance( b.borrower.borrower, b.borrower.deposit_asset );
+
+         update_account_karma(&db(), b.borrower.borrower, KARMA_BONUS_FOR_CREDIT_PAYMENT, karma_credit_completed_forced);
+
+         credit_completed_forced_event e;
+         e.deposit_returned = b.borrower.deposit_asset;
+         b.add_history_event( db( ).head_block_time( ), std::move( e ) );
+
+         b.borrower.deposit_asset = asset( 0, deposit.get_id( ) );
+         b.status = e_credit_object_status::complete_normal;
+         b.next_process_time = time_point_sec::maximum( );
+   });
+   update_credit_statistics( db( ), &before, &credit );
 
-   database& d = db( );  
-   for( auto itr = e.begin( ); itr != e.end( ); itr++ )
-   {       
-      if( ( *itr ).object_uuid.compare( o.credit_request_uuid ) == 0 )
-      {
-            const asset_object& loan = ( *itr ).borrower.loan_asset.asset_id( d );
-            const account_object& borrower_account = o.borrower( db( ) );
-            double settle_sum = 0.0;  
-
-            if( ( *itr ).status != e_credit_object_status::in_progress )
-                  FC_ASSERT( 0, "credit request don't accepted!" );
-
-            if(o.borrower != ( *itr ).borrower.borrower)
-                  FC_ASSERT( 0, "Only owner can settle the credit operation!" );
-
-            if( ( *itr ).settle_month_elapsed == 0 )
-                  settle_sum = ( *itr ).borrower.loan_persent / 12.0 + loan.amount_to_real( ( *itr ).borrower.loan_asset.amount );
-            else
-                  settle_sum = ( *itr ).creditor.monthly_payment * ( ( *itr ).borrower.loan_period - ( *itr ).settle_month_elapsed );   
-            
-            asset settle( settle_sum * pow( 10, loan.precision), loan.get_id( ) );
-
-            bool insufficient_balance = db( ).get_balance( borrower_account, loan ).amount >= settle.amount;
-            FC_ASSERT( insufficient_balance, "Insufficient Balance" );  
-
-            db( ).adjust_balance( ( *itr ).borrower.borrower, -settle );
-            db( ).adjust_balance( ( *itr ).creditor.creditor, settle );                   
-
-            db( ).modify( *itr, [this,&o,&ret,&d]( credit_object& b ) 
-            {
-                  const asset_object& deposit = b.borrower.deposit_asset.asset_id( d );
-                  db( ).adjust_balance( b.borrower.borrower, b.borrower.deposit_asset );
-        
-                  update_account_karma(&db(), b.borrower.borrower, KARMA_BONUS_FOR_CREDIT_PAYMENT, "Credit complete forced.");
-
-                  std::stringstream ss;
-                  std::string time_json = db( ).head_block_time( ).to_iso_string( );
-                  ss << time_json << " : " << "Credit complete forced, " << deposit.amount_to_pretty_string( b.borrower.deposit_asset ) << " returned.";
-                  b.history.push_back( ss.str( ) );
-
-                  boost::property_tree::ptree root, details;
-                  std::stringstream ss_json;
-
-                  if(b.history_json.size())
-                  {
-                        ss_json << b.history_json;
-                        boost::property_tree::read_json(ss_json, root);      
-                        ss_json.str( std::string() );
-                        ss_json.clear();
-                  }      
-                  
-                  details.put("type","credit_complete_forced");
-                  details.put("status","deposit_returned");
-                  details.put("asset",deposit.symbol);
-                  details.put("sum",deposit.amount_to_string( b.borrower.deposit_asset.amount));
-                  root.add_child(time_json, details);
-
-                  boost::property_tree::write_json(ss_json, root);
-                  b.history_json = ss_json.str();
-                  b.history_json.erase(std::remove(b.history_json.begin(), b.history_json.end(), '\n'), b.history_json.end());
-                  b.history_json.erase(std::remove(b.history_json.begin(), b.history_json.end(), ' '), b.history_json.end());
-
-                  b.borrower.deposit_asset = asset( 0, deposit.get_id( ) );
-                  b.status = e_credit_object_status::complete_normal;
-            });
-
-            credit_request_founded = true;
-            break;
-      }
-   }
-   FC_ASSERT( credit_request_founded, "credit request not found!" );
    return ret;
 } FC_CAPTURE_AND_RETHROW( ( o ) ) }
 
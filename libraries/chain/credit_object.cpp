@@ -1,9 +1,14 @@
 #include <graphene/chain/credit_object.hpp>
+#include <graphene/chain/credit_money.hpp>
 #include <graphene/chain/exchange_rate_object.hpp>
 #include <graphene/chain/asset_object.hpp>
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/hardfork.hpp>
 #include <fc/uint128.hpp>
+#include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
+
+#include <sstream>
 
 namespace graphene { namespace chain 
 {
@@ -11,41 +16,85 @@ namespace graphene { namespace chain
     {       
         if( status == e_credit_object_status::in_progress )
         {
+            share_type deposit_before = borrower.deposit_asset.amount;
+
             if( borrower.collateral_free == false )
                 if( check_deposit_quotes( db ) == false)
+                {
+                        schedule_next_process( *db );
                         return; // credit already closed ubnormal
-            
-            uint32_t seconds_per_day = db->get_global_properties().parameters.get_credit_options().seconds_per_day;
-                        
-            boost::posix_time::ptime         credit_start_time = boost::posix_time::from_time_t( request_approvation_time.sec_since_epoch( ) );
-            boost::gregorian::month_iterator itr( credit_start_time.date() - boost::gregorian::date_duration(1), settle_month_elapsed+1);
-            boost::gregorian::date           pay_date = *(++itr);
-            
-            // next pay day from request_approvation_time.
-            int next_pay_count_days = boost::gregorian::date_period(credit_start_time.date(),pay_date).length().days();
-            long next_pay_total_secs = next_pay_count_days * seconds_per_day;
-
-            boost::posix_time::ptime cur_time = boost::posix_time::from_time_t( db->head_block_time( ).sec_since_epoch( ) );
-
-            if( (cur_time - credit_start_time).total_seconds() >= next_pay_total_secs || expired_time_start)
+                }
+
+            if( db->head_block_time( ) >= next_payment_time( *db ) || expired_time_start)
             {
                 on_next_month( db );
 
                 if( settle_month_elapsed >= borrower.loan_period )
                     complete_credit_operation( db );
             }
+
+            // a deposit reduced by settlement has to pass the quotes check again on the next block
+            schedule_next_process( *db, borrower.deposit_asset.amount != deposit_before );
         }                  
     }
 
-    void credit_object::on_next_month( graphene::chain::database* db )
+    time_point_sec credit_object::next_payment_time( const graphene::chain::database& db )const
+    {
+        uint32_t seconds_per_day = db.get_credit_options().seconds_per_day;
+
+        boost::posix_time::ptime         credit_start_time = boost::posix_time::from_time_t( request_approvation_time.sec_since_epoch( ) );
+        boost::gregorian::month_iterator itr( credit_start_time.date() - boost::gregorian::date_duration(1), settle_month_elapsed+1);
+        boost::gregorian::date           pay_date = *(++itr);
+
+        // next pay day from request_approvation_time.
+        int next_pay_count_days = boost::gregorian::date_period(credit_start_time.date(),pay_date).length().days();
+        uint32_t next_pay_total_secs = next_pay_count_days * seconds_per_day;
+
+        return request_approvation_time + next_pay_total_secs;
+    }
+
+    time_point_sec credit_object::overdue_deadline( const graphene::chain::database& db )const
+    {
+        const auto& options = db.get_credit_options();
+        uint32_t max_credit_expiration_time = options.max_credit_expiration_days * options.seconds_per_day;
+        uint64_t deadline = uint64_t( expired_time_start ) + max_credit_expiration_time;
+        return deadline < time_point_sec::maximum( ).sec_since_epoch( ) ? time_point_sec( uint32_t( deadline ) )
+                                                                        : time_point_sec::maximum( );
+    }
+
+    asset credit_object::monthly_payment_asset( const graphene::chain::database& db )const
+    {
+        return credit_money::from_real( borrower.loan_asset.asset_id( db ), creditor.monthly_payment ).to_asset( );
+    }
+
+    bool credit_object::borrower_can_pay( const graphene::chain::database& db )const
+    {
+        return db.get_balance( borrower.borrower, borrower.loan_asset.asset_id ) >= monthly_payment_asset( db );
+    }
+
+    /**
+     * An overdue credit changes again when its deadline passes or when the borrower can pay, the latter is
+     * signalled by database::adjust_balance, so it is not due on every block in between.
+     */
+    time_point_sec credit_object::scheduled_process_time( const graphene::chain::database& db, bool recheck_deposit )const
     {
-        const account_object& borrower_account = borrower.borrower( *db );     
-        const asset_object& loan_asset_type = borrower.loan_asset.asset_id( *db );          
+        if( status != e_credit_object_status::in_progress )
+            return time_point_sec::maximum();
+        if( recheck_deposit || ( expired_time_start && borrower_can_pay( db ) ) )
+            return db.head_block_time( ); // due again on the very next block
+        if( expired_time_start )
+            return overdue_deadline( db );
+        return next_payment_time( db );
+    }
 
-        asset monthly_payment( creditor.monthly_payment * pow(10, loan_asset_type.precision), loan_asset_type.get_id( ) );       
-        bool sufficient_balance = db->get_balance( borrower_account, loan_asset_type ) >= monthly_payment;
+    void credit_object::schedule_next_process( const graphene::chain::database& db, bool recheck_deposit )
+    {
+        next_process_time = scheduled_process_time( db, recheck_deposit );
+    }
 
-        if( sufficient_balance )
+    void credit_object::on_next_month( graphene::chain::database* db )
+    {
+        if( borrower_can_pay( *db ) )
             settle_monthly_payment( db );       
         else 
             check_expired_pay_time( db );
@@ -69,93 +118,43 @@ namespace graphene { namespace chain
     void credit_object::settle_monthly_payment( graphene::chain::database* db )
     {
         const asset_object& loan = borrower.loan_asset.asset_id( *db );  
-        const asset_object& deposit = borrower.deposit_asset.asset_id( *db ); 
 
-        asset tmp( creditor.monthly_payment * pow(10, loan.precision), loan.get_id( ) ); 
+        asset tmp = credit_money::from_real( loan, creditor.monthly_payment ).to_asset( );
         db->adjust_balance( borrower.borrower, -tmp );
         db->adjust_balance( creditor.creditor, tmp );
 
-        update_account_karma(db, borrower.borrower, KARMA_BONUS_FOR_MONTHLY_PAYMENT, "Settle monthly payment complete normal.");
+        update_account_karma(db, borrower.borrower, KARMA_BONUS_FOR_MONTHLY_PAYMENT, karma_monthly_payment_settled);
 
         expired_time_start = 0;
+        monthly_inflows += tmp.amount;
 
-        std::stringstream ss;
-        std::string time_json = db->head_block_time( ).to_iso_string( );
-        ss << time_json << " : " << "Settle monthly payment complete normal, " << loan.amount_to_pretty_string( tmp ) << " settled."
-        << " month elapsed - " << settle_month_elapsed + 1
-        << " deposit left = " << deposit.amount_to_pretty_string( borrower.deposit_asset );
-        history.push_back( ss.str( ) );
-
-        boost::property_tree::ptree root, details;
-        std::stringstream ss_json;
-
-        if(history_json.size())
-        {
-            ss_json << history_json;
-            boost::property_tree::read_json(ss_json, root);    
-            ss_json.str( std::string() );
-            ss_json.clear();
-        }
-        details.put("type","monthly_settlement");
-        details.put("status","normal");
-        details.put("sum_settled",loan.amount_to_string( tmp ));
-        details.put("asset_settled",loan.symbol);
-        details.put("month_elapsed",settle_month_elapsed + 1);
-        details.put("deposit_asset",deposit.symbol);
-        details.put("deposit_left_sum",deposit.amount_to_string(borrower.deposit_asset.amount));
-        root.add_child(time_json, details);
-
-        boost::property_tree::write_json(ss_json, root);
-        history_json = ss_json.str();
-        history_json.erase(std::remove(history_json.begin(), history_json.end(), '\n'), history_json.end());
-        history_json.erase(std::remove(history_json.begin(), history_json.end(), ' '), history_json.end());
+        monthly_payment_settled_event e;
+        e.settled = tmp;
+        e.month_elapsed = settle_month_elapsed + 1;
+        e.deposit_left = borrower.deposit_asset;
+        add_history_event( db->head_block_time( ), std::move( e ) );
     }
 
     void credit_object::check_expired_pay_time( graphene::chain::database* db )
     {
-        uint32_t max_days = db->get_global_properties().parameters.get_credit_options().max_credit_expiration_days;
+        const auto& options = db->get_credit_options();
+        uint32_t max_days = options.max_credit_expiration_days;
         if ( (expired_time_start == 0) && (max_days != 0) )
         {
             const asset_object& loan = borrower.loan_asset.asset_id( *db );  
-            asset tmp( creditor.monthly_payment * pow(10, loan.precision), loan.get_id( ) ); 
+            asset tmp = credit_money::from_real( loan, creditor.monthly_payment ).to_asset( );
          
             expired_time_start = db->head_block_time( ).sec_since_epoch( );
 
-            update_account_karma(db, borrower.borrower, KARMA_PENALTY_FOR_MONTHLY_DELAY, "Settle monthly payment complete ubnormal: insufficient balance.");
+            update_account_karma(db, borrower.borrower, KARMA_PENALTY_FOR_MONTHLY_DELAY, karma_monthly_payment_delayed);
 
-            std::stringstream ss;
-            std::string time_json = db->head_block_time( ).to_iso_string( );
-            ss << time_json << " : " << "Settle monthly payment complete ubnormal: insufficient balance. " 
-            << loan.amount_to_pretty_string( tmp ) << " not settled.";
-            history.push_back( ss.str( ) );
-
-            boost::property_tree::ptree root, details;
-            std::stringstream ss_json;
-
-            if(history_json.size())
-            {
-                ss_json << history_json;
-                boost::property_tree::read_json(ss_json, root);    
-                ss_json.str( std::string() );
-                ss_json.clear();
-            }
-            details.put("type","monthly_settlement");
-            details.put("status","insufficient_balance");
-            details.put("sum_not_settled",loan.amount_to_string( tmp ));
-            details.put("asset",loan.symbol);
-            root.add_child(time_json, details);
-
-            boost::property_tree::write_json(ss_json, root);
-            history_json = ss_json.str();
-            history_json.erase(std::remove(history_json.begin(), history_json.end(), '\n'), history_json.end());
-            history_json.erase(std::remove(history_json.begin(), history_json.end(), ' '), history_json.end());
+            monthly_payment_missed_event e;
+            e.not_settled = tmp;
+            add_history_event( db->head_block_time( ), std::move( e ) );
             return; 
         }    
         
-        uint32_t max_credit_expiration_days = db->get_global_properties().parameters.get_credit_options().max_credit_expiration_days;
-        uint32_t max_credit_expiration_time = max_credit_expiration_days * db->get_global_properties().parameters.get_credit_options().seconds_per_day;
-        
-        if( (db->head_block_time( ).sec_since_epoch( ) - expired_time_start) >= max_credit_expiration_time)
+        if( db->head_block_time( ) >= overdue_deadline( *db ) )
         {
             if(borrower.collateral_free)
                 complete_credit_operation_ubnormal( db );
@@ -174,8 +173,8 @@ namespace graphene { namespace chain
         if( deposit_left == 0.0 )
             return complete_credit_operation_ubnormal( db );
 
-        double deposit_exchange_rate = get_exchange_rate_by_symbol(db, deposit.symbol);
-        double loan_exchange_rate = get_exchange_rate_by_symbol(db, loan.symbol);
+        double deposit_exchange_rate = get_exchange_rate(*db, deposit);
+        double loan_exchange_rate = get_exchange_rate(*db, loan);
 
         double loan_left_on_borrower_account = loan.amount_to_real( db->get_balance( borrower.borrower, loan.get_id( ) ).amount );
         double debt_in_deposit = (creditor.monthly_payment - loan_left_on_borrower_account) * loan_exchange_rate/deposit_exchange_rate;
@@ -184,78 +183,48 @@ namespace graphene { namespace chain
         double loan_to_core = creditor.monthly_payment * loan_exchange_rate;
 
         // try return settle_amount = loan_left_on_borrower_account + debt_in_deposit
-        asset loan_asset_from_borrower(loan_left_on_borrower_account * pow(10, loan.precision),loan.get_id());
-        asset deposit_asset_from_deposit(debt_in_deposit * pow(10, deposit.precision), deposit.get_id());
-        asset loan_asset_to_creditor(creditor.monthly_payment * pow(10, loan.precision),loan.get_id());
+        asset loan_asset_from_borrower = credit_money::from_real( loan, loan_left_on_borrower_account ).to_asset( );
+        asset deposit_asset_from_deposit = credit_money::from_real( deposit, debt_in_deposit ).to_asset( );
+        asset loan_asset_to_creditor = credit_money::from_real( loan, creditor.monthly_payment ).to_asset( );
 
         bool fail = false;   
         //We shouldn`t be here. We can`t return sattle_amount sum. We use all deposit to return as much as possible.
         if( deposit_left < debt_in_deposit )
         {
             double loan_from_all_deposit = deposit_left * deposit_exchange_rate / loan_exchange_rate;
-            loan_asset_to_creditor.amount = (loan_from_all_deposit + loan_left_on_borrower_account) * pow(10, loan.precision);
-            deposit_asset_from_deposit.amount = deposit_left * pow(10, deposit.precision);    
+            loan_asset_to_creditor.amount = credit_money::from_real( loan, loan_from_all_deposit + loan_left_on_borrower_account ).amount( );
+            deposit_asset_from_deposit.amount = credit_money::from_real( deposit, deposit_left ).amount( );
             fail = true;
         }
         
         db->adjust_balance( borrower.borrower, -loan_asset_from_borrower );
         db->adjust_balance( creditor.creditor, loan_asset_to_creditor );
+        monthly_inflows += loan_asset_to_creditor.amount;
         borrower.deposit_asset -= deposit_asset_from_deposit;
         
         // check convertation
         if(loan_asset_from_borrower.asset_id != loan_asset_to_creditor.asset_id)
         {
-            auto itr_account_obj = db->get_index_type<account_index>().indices().get<by_name>().find(SPECIAL_CONVERSION_ACCOUNT);
-            account_id_type karma_id = (*itr_account_obj).get_id();
+            const account_object* conversion_account = db->find_conversion_account( );
+            FC_ASSERT( conversion_account != nullptr, "No conversion account found: ${a}.", ("a", SPECIAL_CONVERSION_ACCOUNT) );
+            account_id_type karma_id = conversion_account->get_id();
             db->adjust_balance( karma_id, deposit_asset_from_deposit );
         
             double loan_need_to_be_balanced = deposit.amount_to_real(deposit_asset_from_deposit.amount) * deposit_exchange_rate/loan_exchange_rate;
             db->modify(loan.dynamic_asset_data_id(*db), [&](asset_dynamic_data_object& dynamic_asset) {
-            dynamic_asset.current_supply += loan_need_to_be_balanced*pow(10,loan.precision);
+            dynamic_asset.current_supply += credit_money::from_real( loan, loan_need_to_be_balanced ).amount( );
             });
         }    
 
-        std::stringstream ss;
-        std::string time_json = db->head_block_time( ).to_iso_string( );
-        ss << time_json << " : " << "Settle monthly payment complete ubnormal, " 
-        << loan.amount_to_pretty_string( loan_asset_from_borrower ) << " settled from borrower. "
-        << deposit.amount_to_pretty_string( deposit_asset_from_deposit ) << " settled from deposit. "
-        << loan.amount_to_pretty_string( loan_asset_to_creditor ) << " transfered " 
-        << " deposit to core = " << deposit_to_core << " loan to core = " << loan_to_core
-        << " month elapsed = " << settle_month_elapsed + 1
-        << " deposit left = " << deposit.amount_to_pretty_string( borrower.deposit_asset );
-        history.push_back( ss.str( ) );
-
-        boost::property_tree::ptree root, details;
-        std::stringstream ss_json;
-
-        if(history_json.size())
-        {
-            ss_json << history_json;
-            boost::property_tree::read_json(ss_json, root);    
-            ss_json.str( std::string() );
-            ss_json.clear();
-        }
-
-        details.put("type","monthly_settlement");
-        details.put("status","ubnormal");
-        details.put("settled_from_borrower_asset",loan.symbol);
-        details.put("settled_from_borrower_sum",loan.amount_to_string( loan_asset_from_borrower ));
-        details.put("settled_from_deposit_asset",deposit.symbol);
-        details.put("settled_from_deposit_sum",deposit.amount_to_string( deposit_asset_from_deposit ));
-        details.put("transfered_sum",loan.amount_to_string( loan_asset_to_creditor ));
-        details.put("transfered_asset",loan.symbol);
-        details.put("deposit_to_core",deposit_to_core);
-        details.put("loan_to_core",loan_to_core);
-        details.put("month_elapsed",settle_month_elapsed + 1);
-        details.put("deposit_asset",deposit.symbol);
-        details.put("deposit_left_sum",deposit.amount_to_string( borrower.deposit_asset ));
-        root.add_child(time_json, details);
-
-        boost::property_tree::write_json(ss_json, root);
-        history_json = ss_json.str();
-        history_json.erase(std::remove(history_json.begin(), history_json.end(), '\n'), history_json.end());
-        history_json.erase(std::remove(history_json.begin(), history_json.end(), ' '), history_json.end());
+        monthly_payment_settled_from_deposit_event e;
+        e.from_borrower = loan_asset_from_borrower;
+        e.from_deposit = deposit_asset_from_deposit;
+        e.transfered = loan_asset_to_creditor;
+        e.deposit_to_core = deposit_to_core;
+        e.loan_to_core = loan_to_core;
+        e.month_elapsed = settle_month_elapsed + 1;
+        e.deposit_left = borrower.deposit_asset;
+        add_history_event( db->head_block_time( ), std::move( e ) );
 
         if(fail)
             return complete_credit_operation_ubnormal(db);
@@ -268,34 +237,11 @@ namespace graphene { namespace chain
         const asset_object& deposit = borrower.deposit_asset.asset_id( *db );
         db->adjust_balance( borrower.borrower, borrower.deposit_asset );
         
-        update_account_karma(db, borrower.borrower, KARMA_BONUS_FOR_CREDIT_PAYMENT, "Credit complete normal.");
-
-        std::stringstream ss;
-        std::string time_json = db->head_block_time( ).to_iso_string( );
-        ss << time_json << " : " << "Credit complete normal, " << deposit.amount_to_pretty_string( borrower.deposit_asset ) << " returned.";
-        history.push_back( ss.str( ) );
+        update_account_karma(db, borrower.borrower, KARMA_BONUS_FOR_CREDIT_PAYMENT, karma_credit_completed);
 
-        boost::property_tree::ptree root, details;
-        std::stringstream ss_json;
-
-        if(history_json.size())
-        {
-            ss_json << history_json;
-            boost::property_tree::read_json(ss_json, root);    
-            ss_json.str( std::string() );
-            ss_json.clear();
-        }
-
-        details.put("type","credit_complete");
-        details.put("status","normal");
-        details.put("returned_deposit_sum",deposit.amount_to_string( borrower.deposit_asset.amount));
-        details.put("returned_deposit_asset",deposit.symbol);
-        root.add_child(time_json, details);
-
-        boost::property_tree::write_json(ss_json, root);
-        history_json = ss_json.str();
-        history_json.erase(std::remove(history_json.begin(), history_json.end(), '\n'), history_json.end());
-        history_json.erase(std::remove(history_json.begin(), history_json.end(), ' '), history_json.end());
+        credit_completed_event e;
+        e.deposit_returned = borrower.deposit_asset;
+        add_history_event( db->head_block_time( ), std::move( e ) );
 
         borrower.deposit_asset = asset( 0, deposit.get_id( ) );
         status = e_credit_object_status::complete_normal;
@@ -308,75 +254,79 @@ namespace graphene { namespace chain
         const asset_object& loan = borrower.loan_asset.asset_id( *db );
 
         double loan_left_on_borrower_account = loan.amount_to_real( db->get_balance( borrower.borrower, loan.get_id( ) ).amount );
-        asset loan_asset_to_creditor( loan_left_on_borrower_account * pow(10, loan.precision), loan.get_id( ) );
+        asset loan_asset_to_creditor = credit_money::from_real( loan, loan_left_on_borrower_account ).to_asset( );
 
         db->adjust_balance( borrower.borrower, -loan_asset_to_creditor );
         db->adjust_balance( creditor.creditor, loan_asset_to_creditor );
 
-        update_account_karma(db, borrower.borrower, KARMA_PENALTY_FOR_CREDIT_DEFAULT, "Credit complete ubnormal.");
+        update_account_karma(db, borrower.borrower, KARMA_PENALTY_FOR_CREDIT_DEFAULT, karma_credit_defaulted);
 
-        std::stringstream ss;
-        std::string time_json = db->head_block_time( ).to_iso_string( );
-        ss << time_json << " : " << "Credit complete ubnormal, " << loan.amount_to_pretty_string( loan_asset_to_creditor ) << " transfered."
-        << " Deposit sum returned: " << deposit.amount_to_pretty_string( borrower.deposit_asset );
-        history.push_back( ss.str( ) );
+        credit_defaulted_event e;
+        e.transfered = loan_asset_to_creditor;
+        e.deposit_returned = borrower.deposit_asset;
+        add_history_event( db->head_block_time( ), std::move( e ) );
 
-        boost::property_tree::ptree root, details;
-        std::stringstream ss_json;
+        status = e_credit_object_status::complete_ubnormal;
+    }
 
-        if(history_json.size())
-        {
-            ss_json << history_json;
-            boost::property_tree::read_json(ss_json, root);    
-            ss_json.str( std::string() );
-            ss_json.clear();
-        }        
-
-        details.put("type","credit_complete");
-        details.put("status","ubnormal");
-        details.put("transfered_sum",loan.amount_to_string( loan_asset_to_creditor));
-        details.put("transfered_asset",loan.symbol);
-        details.put("deposit_sum_returned",deposit.amount_to_string(borrower.deposit_asset));
-        details.put("deposit_asset",deposit.symbol);
-        root.add_child(time_json, details);
-
-        boost::property_tree::write_json(ss_json, root);
-        history_json = ss_json.str();
-        history_json.erase(std::remove(history_json.begin(), history_json.end(), '\n'), history_json.end());
-        history_json.erase(std::remove(history_json.begin(), history_json.end(), ' '), history_json.end());
+    bool credit_object::deposit_covers_loan( const graphene::chain::database& db )const
+    {
+        const asset_object& deposit = borrower.deposit_asset.asset_id( db );
+        const asset_object& loan = borrower.loan_asset.asset_id( db );
 
-        status = e_credit_object_status::complete_ubnormal;
+        double deposit_in_core = deposit.amount_to_real( borrower.deposit_asset.amount ) * get_exchange_rate(db, deposit);
+        double loan_in_core = loan.amount_to_real( borrower.loan_asset.amount ) * get_exchange_rate(db, loan);
+
+        return deposit_in_core > ( loan_in_core / 100 ) * ( DEPOSIT_PERSENT / 2 );
+    }
+
+    bool credit_object::needs_processing( const graphene::chain::database& db )const
+    {
+        if( status != e_credit_object_status::in_progress )
+            return false;
+
+        if( !borrower.collateral_free && !deposit_covers_loan( db ) )
+            return true; // stop-loss
+
+        if( !expired_time_start && db.head_block_time( ) < next_payment_time( db ) )
+            return false;
+
+        if( borrower_can_pay( db ) )
+            return true;
+
+        // an unpaid payment starts the overdue period, which ends with the settlement from the deposit or a default
+        return !expired_time_start || db.head_block_time( ) >= overdue_deadline( db );
     }
 
     bool credit_object::check_deposit_quotes( graphene::chain::database* db )
     {
+        if( deposit_covers_loan( *db ) )
+            return true;
+
         const asset_object& deposit = borrower.deposit_asset.asset_id( *db );      
         const asset_object& loan = borrower.loan_asset.asset_id( *db );
 
-        double deposit_exchange_rate = get_exchange_rate_by_symbol(db, deposit.symbol);
-        double loan_exchange_rate = get_exchange_rate_by_symbol(db, loan.symbol);
+        double deposit_exchange_rate = get_exchange_rate(*db, deposit);
+        double loan_exchange_rate = get_exchange_rate(*db, loan);
 
         double deposit_in_core = deposit.amount_to_real( borrower.deposit_asset.amount ) * deposit_exchange_rate;
         double loan_in_core = loan.amount_to_real( borrower.loan_asset.amount ) * loan_exchange_rate;  
-
-        if( deposit_in_core > ( loan_in_core / 100 ) * ( DEPOSIT_PERSENT / 2 ) )
-            return true;
         
         // Complete credit Stop-Loss Order
         double loan_for_return = creditor.monthly_payment * ( borrower.loan_period - settle_month_elapsed );
         double loan_left_on_borrower_account = loan.amount_to_real( db->get_balance( borrower.borrower, loan.get_id( ) ).amount );
 
         // ideal situation - we have enough loan asset on borrower account
-        asset loan_asset_from_borrower(loan_for_return * pow(10, loan.precision),loan.get_id());
+        asset loan_asset_from_borrower = credit_money::from_real( loan, loan_for_return ).to_asset( );
         asset loan_asset_to_creditor(loan_asset_from_borrower);
         asset deposit_asset_from_deposit(0, deposit.get_id());
    
         // if situation not ideal
         if( loan_left_on_borrower_account < loan_for_return )
         {
-            loan_asset_from_borrower.amount = loan_left_on_borrower_account * pow(10, loan.precision); 
+            loan_asset_from_borrower.amount = credit_money::from_real( loan, loan_left_on_borrower_account ).amount( );
             double debt_in_deposit = (loan_for_return - loan_left_on_borrower_account) * loan_exchange_rate/deposit_exchange_rate;
-            deposit_asset_from_deposit.amount = debt_in_deposit * pow(10, deposit.precision);
+            deposit_asset_from_deposit.amount = credit_money::from_real( deposit, debt_in_deposit ).amount( );
         
             double deposit_left = deposit.amount_to_real( borrower.deposit_asset.amount );
 
@@ -384,8 +334,8 @@ namespace graphene { namespace chain
             if( deposit_left < debt_in_deposit )
             {
                 double loan_from_all_deposit = deposit_left * deposit_exchange_rate / loan_exchange_rate;
-                loan_asset_to_creditor.amount = (loan_from_all_deposit + loan_left_on_borrower_account) * pow(10, loan.precision);
-                deposit_asset_from_deposit.amount = deposit_left * pow(10, deposit.precision);    
+                loan_asset_to_creditor.amount = credit_money::from_real( loan, loan_from_all_deposit + loan_left_on_borrower_account ).amount( );
+                deposit_asset_from_deposit.amount = credit_money::from_real( deposit, deposit_left ).amount( );
             }
         }    
 
@@ -395,58 +345,291 @@ namespace graphene { namespace chain
         
         if(loan_asset_from_borrower.asset_id != loan_asset_to_creditor.asset_id)
         {
-            auto itr_account_obj = db->get_index_type<account_index>().indices().get<by_name>().find(SPECIAL_CONVERSION_ACCOUNT);
-            account_id_type karma_id = (*itr_account_obj).get_id();
+            const account_object* conversion_account = db->find_conversion_account( );
+            FC_ASSERT( conversion_account != nullptr, "No conversion account found: ${a}.", ("a", SPECIAL_CONVERSION_ACCOUNT) );
+            account_id_type karma_id = conversion_account->get_id();
             db->adjust_balance( karma_id, deposit_asset_from_deposit );
 
             double loan_need_to_be_balanced = deposit.amount_to_real(deposit_asset_from_deposit.amount) * deposit_exchange_rate/loan_exchange_rate;
             db->modify(loan.dynamic_asset_data_id(*db), [&](asset_dynamic_data_object& dynamic_asset) {
-            dynamic_asset.current_supply += loan_need_to_be_balanced*pow(10,loan.precision);
+            dynamic_asset.current_supply += credit_money::from_real( loan, loan_need_to_be_balanced ).amount( );
             });
         }    
         
         db->adjust_balance( borrower.borrower, borrower.deposit_asset );
 
-        boost::property_tree::ptree root, details;
-        std::stringstream ss, ss_json;
-        std::string time_json = db->head_block_time( ).to_iso_string( );
-
-        ss << time_json << " : " << "Stop-Loss Order, deposit in core = " << deposit_in_core 
-        << " less then " << ( DEPOSIT_PERSENT / 2 ) << "% of loan in core = " << ( loan_in_core / 100 ) * ( DEPOSIT_PERSENT / 2 )
-        << " " << loan.amount_to_pretty_string( loan_asset_from_borrower ) << " settled from borrower. "
-        << deposit.amount_to_pretty_string( deposit_asset_from_deposit ) << " settled from deposit. "
-        << loan.amount_to_pretty_string( loan_asset_to_creditor ) << " transfered " 
-        << "deposit - " << deposit.amount_to_pretty_string( borrower.deposit_asset ) << " returned.";
-
-        if(history_json.size())
-        {
-            ss_json << history_json;
-            boost::property_tree::read_json(ss_json, root);    
-            ss_json.str( std::string() );
-            ss_json.clear();
-        }        
-
-        details.put("type","stop-loss_order");
-        details.put("deposit_in_core",deposit_in_core);
-        std::string json_tmp_str = std::to_string(DEPOSIT_PERSENT / 2) + "%_of_loan_in_core";
-        details.put(json_tmp_str,( loan_in_core / 100 ) * ( DEPOSIT_PERSENT / 2 ));
-        details.put("settled_from_borrower_asset",loan.symbol);
-        details.put("settled_from_borrower_sum",loan.amount_to_string( loan_asset_from_borrower ));
-        details.put("settled_from_deposit_asset",deposit.symbol);
-        details.put("settled_from_deposit_sum",deposit.amount_to_string( deposit_asset_from_deposit ));
-        details.put("transfered_sum",loan.amount_to_string( loan_asset_to_creditor ));
-        details.put("transfered_asset",loan.symbol);
-        details.put("deposit_returned_asset",deposit.symbol);
-        details.put("deposit_returned_sum",deposit.amount_to_string( borrower.deposit_asset ));
-        history.push_back( ss.str( ) );          
-        root.add_child(time_json, details);
-        boost::property_tree::write_json(ss_json, root);
-        history_json = ss_json.str();
-        history_json.erase(std::remove(history_json.begin(), history_json.end(), '\n'), history_json.end());
-        history_json.erase(std::remove(history_json.begin(), history_json.end(), ' '), history_json.end());
+        stop_loss_event e;
+        e.deposit_in_core = deposit_in_core;
+        e.loan_threshold_in_core = ( loan_in_core / 100 ) * ( DEPOSIT_PERSENT / 2 );
+        e.from_borrower = loan_asset_from_borrower;
+        e.from_deposit = deposit_asset_from_deposit;
+        e.transfered = loan_asset_to_creditor;
+        e.deposit_returned = borrower.deposit_asset;
+        add_history_event( db->head_block_time( ), std::move( e ) );
 
         borrower.deposit_asset = asset( 0, deposit.get_id( ) );
         status = e_credit_object_status::complete_ubnormal;
         return false;
     }
-}}
\ No newline at end of file
+
+    namespace {
+        int hex_digit_value( char c )
+        {
+            if( c >= '0' && c <= '9' ) return c - '0';
+            if( c >= 'a' && c <= 'f' ) return c - 'a' + 10;
+            if( c >= 'A' && c <= 'F' ) return c - 'A' + 10;
+            return -1;
+        }
+
+        /// renders one history event as the text line and the json details served by database_api
+        struct credit_history_renderer
+        {
+            typedef void result_type;
+
+            const graphene::chain::database& db;
+            std::ostringstream&              line;
+            fc::mutable_variant_object&      details;
+
+            std::string pretty( const asset& a )const { return a.asset_id( db ).amount_to_pretty_string( a ); }
+            std::string amount( const asset& a )const { return a.asset_id( db ).amount_to_string( a ); }
+            std::string symbol( const asset& a )const { return a.asset_id( db ).symbol; }
+            template<typename T>
+            static std::string str( const T& v ) { std::ostringstream ss; ss << v; return ss.str(); }
+
+            void operator()( const credit_created_event& e )const
+            {
+                const std::string& name = e.borrower( db ).name;
+                line << "was created with id = " << e.uuid << " by - " << name;
+                details( "type", "request_creation" )( "id", e.uuid )( "borrower", name );
+            }
+
+            void operator()( const credit_approved_event& e )const
+            {
+                const std::string& name = e.creditor( db ).name;
+                std::string monthly_payment = std::to_string( e.monthly_payment );
+                line << "credit with id = " << e.uuid << " was accepted by - " << name
+                     << " loan_amount = " << amount( e.loan )
+                     << " loan_period_in_month = " << e.loan_period << " monthly_payment = " << monthly_payment;
+                details( "type", "request_approved" )( "id", e.uuid )( "creditor", name )
+                       ( "loan_amount", amount( e.loan ) )( "loan_period_in_month", str( e.loan_period ) )
+                       ( "monthly_payment", monthly_payment );
+            }
+
+            void operator()( const monthly_payment_settled_event& e )const
+            {
+                line << "Settle monthly payment complete normal, " << pretty( e.settled ) << " settled."
+                     << " month elapsed - " << e.month_elapsed
+                     << " deposit left = " << pretty( e.deposit_left );
+                details( "type", "monthly_settlement" )( "status", "normal" )
+                       ( "sum_settled", amount( e.settled ) )( "asset_settled", symbol( e.settled ) )
+                       ( "month_elapsed", str( e.month_elapsed ) )
+                       ( "deposit_asset", symbol( e.deposit_left ) )( "deposit_left_sum", amount( e.deposit_left ) );
+            }
+
+            void operator()( const monthly_payment_missed_event& e )const
+            {
+                line << "Settle monthly payment complete ubnormal: insufficient balance. "
+                     << pretty( e.not_settled ) << " not settled.";
+                details( "type", "monthly_settlement" )( "status", "insufficient_balance" )
+                       ( "sum_not_settled", amount( e.not_settled ) )( "asset", symbol( e.not_settled ) );
+            }
+
+            void operator()( const monthly_payment_settled_from_deposit_event& e )const
+            {
+                line << "Settle monthly payment complete ubnormal, "
+                     << pretty( e.from_borrower ) << " settled from borrower. "
+                     << pretty( e.from_deposit ) << " settled from deposit. "
+                     << pretty( e.transfered ) << " transfered "
+                     << " deposit to core = " << e.deposit_to_core << " loan to core = " << e.loan_to_core
+                     << " month elapsed = " << e.month_elapsed
+                     << " deposit left = " << pretty( e.deposit_left );
+                details( "type", "monthly_settlement" )( "status", "ubnormal" )
+                       ( "settled_from_borrower_asset", symbol( e.from_borrower ) )
+                       ( "settled_from_borrower_sum", amount( e.from_borrower ) )
+                       ( "settled_from_deposit_asset", symbol( e.from_deposit ) )
+                       ( "settled_from_deposit_sum", amount( e.from_deposit ) )
+                       ( "transfered_sum", amount( e.transfered ) )( "transfered_asset", symbol( e.transfered ) )
+                       ( "deposit_to_core", str( e.deposit_to_core ) )( "loan_to_core", str( e.loan_to_core ) )
+                       ( "month_elapsed", str( e.month_elapsed ) )
+                       ( "deposit_asset", symbol( e.deposit_left ) )( "deposit_left_sum", amount( e.deposit_left ) );
+            }
+
+            void operator()( const credit_completed_event& e )const
+            {
+                line << "Credit complete normal, " << pretty( e.deposit_returned ) << " returned.";
+                details( "type", "credit_complete" )( "status", "normal" )
+                       ( "returned_deposit_sum", amount( e.deposit_returned ) )
+                       ( "returned_deposit_asset", symbol( e.deposit_returned ) );
+            }
+
+            void operator()( const credit_defaulted_event& e )const
+            {
+                line << "Credit complete ubnormal, " << pretty( e.transfered ) << " transfered."
+                     << " Deposit sum returned: " << pretty( e.deposit_returned );
+                details( "type", "credit_complete" )( "status", "ubnormal" )
+                       ( "transfered_sum", amount( e.transfered ) )( "transfered_asset", symbol( e.transfered ) )
+                       ( "deposit_sum_returned", amount( e.deposit_returned ) )
+                       ( "deposit_asset", symbol( e.deposit_returned ) );
+            }
+
+            void operator()( const stop_loss_event& e )const
+            {
+                line << "Stop-Loss Order, deposit in core = " << e.deposit_in_core
+                     << " less then " << ( DEPOSIT_PERSENT / 2 ) << "% of loan in core = " << e.loan_threshold_in_core
+                     << " " << pretty( e.from_borrower ) << " settled from borrower. "
+                     << pretty( e.from_deposit ) << " settled from deposit. "
+                     << pretty( e.transfered ) << " transfered "
+                     << "deposit - " << pretty( e.deposit_returned ) << " returned.";
+                details( "type", "stop-loss_order" )( "deposit_in_core", str( e.deposit_in_core ) )
+                       ( std::to_string( DEPOSIT_PERSENT / 2 ) + "%_of_loan_in_core", str( e.loan_threshold_in_core ) )
+                       ( "settled_from_borrower_asset", symbol( e.from_borrower ) )
+                       ( "settled_from_borrower_sum", amount( e.from_borrower ) )
+                       ( "settled_from_deposit_asset", symbol( e.from_deposit ) )
+                       ( "settled_from_deposit_sum", amount( e.from_deposit ) )
+                       ( "transfered_sum", amount( e.transfered ) )( "transfered_asset", symbol( e.transfered ) )
+                       ( "deposit_returned_asset", symbol( e.deposit_returned ) )
+                       ( "deposit_returned_sum", amount( e.deposit_returned ) );
+            }
+
+            void operator()( const credit_completed_forced_event& e )const
+            {
+                line << "Credit complete forced, " << pretty( e.deposit_returned ) << " returned.";
+                details( "type", "credit_complete_forced" )( "status", "deposit_returned" )
+                       ( "asset", symbol( e.deposit_returned ) )( "sum", amount( e.deposit_returned ) );
+            }
+        };
+    }
+
+    void credit_object::render_history( const graphene::chain::database& db )
+    {
+        history.clear( );
+        history.reserve( history_events.size( ) );
+
+        // events are keyed by time like the history_json of earlier versions, so keys may repeat
+        std::string json = "{";
+        for( const credit_history_event& event : history_events )
+        {
+            std::string time = event.time.to_iso_string( );
+            std::ostringstream line;
+            fc::mutable_variant_object details;
+
+            line << time << " : ";
+            event.data.visit( credit_history_renderer{ db, line, details } );
+            history.push_back( line.str( ) );
+
+            if( json.size( ) > 1 )
+                json += ",";
+            json += fc::json::to_string( time ) + ":" + fc::json::to_string( details );
+        }
+        history_json = json + "}";
+    }
+
+    optional<credit_uuid_type> parse_credit_uuid( const std::string& uuid )
+    {
+        if( uuid.size( ) != 36 )
+            return optional<credit_uuid_type>( );
+
+        credit_uuid_type key;
+        size_t byte = 0;
+        for( size_t i = 0; i < uuid.size( ); i += 2 )
+        {
+            if( i == 8 || i == 13 || i == 18 || i == 23 )
+            {
+                if( uuid[i] != '-' )
+                    return optional<credit_uuid_type>( );
+                ++i;
+            }
+
+            int hi = hex_digit_value( uuid[i] );
+            int lo = hex_digit_value( uuid[i + 1] );
+            if( hi < 0 || lo < 0 )
+                return optional<credit_uuid_type>( );
+            key.data[byte++] = char( ( hi << 4 ) | lo );
+        }
+        return key;
+    }
+
+    const credit_object* find_credit_by_uuid( const database& db, const std::string& uuid )
+    {
+        optional<credit_uuid_type> key = parse_credit_uuid( uuid );
+        if( !key.valid( ) )
+            return nullptr;
+
+        // the binary key ignores the case of the hex digits, the stored text decides the match
+        const auto& idx = db.get_index_type<credit_index>( ).indices( ).get<by_uuid>( );
+        auto range = idx.equal_range( boost::make_tuple( *key ) );
+        for( auto itr = range.first; itr != range.second; ++itr )
+            if( itr->object_uuid == uuid )
+                return &*itr;
+        return nullptr;
+    }
+
+    void credit_parameters_index::object_inserted( const object& obj )
+    {
+        _valid = false;
+    }
+
+    void credit_parameters_index::object_removed( const object& obj )
+    {
+        _valid = false;
+    }
+
+    void credit_parameters_index::object_modified( const object& after )
+    {
+        _valid = false;
+    }
+
+    void credit_parameters_index::refresh( const database& db )const
+    {
+        if( _valid )
+            return;
+
+        const chain_parameters& parameters = db.get_global_properties( ).parameters;
+        _credit_options = parameters.get_credit_options( );
+        _bonus_options = parameters.get_bonus_options( );
+        _valid = true;
+    }
+
+    const account_object* credit_parameters_index::find_account( const database& db, optional<account_id_type>& cached, const string& name )const
+    {
+        if( cached.valid( ) )
+        {
+            // an undo may have removed the account and freed its id, the parameters may name another one
+            const account_object* account = db.find( *cached );
+            if( account != nullptr && account->name == name )
+                return account;
+            cached.reset( );
+        }
+
+        const auto& idx = db.get_index_type<account_index>( ).indices( ).get<by_name>( );
+        auto itr = idx.find( name );
+        if( itr == idx.end( ) )
+            return nullptr;
+        cached = itr->get_id( );
+        return &*itr;
+    }
+
+    const chain_parameters::ext::credit_options& credit_parameters_index::credit_options( const database& db )const
+    {
+        refresh( db );
+        return _credit_options;
+    }
+
+    const chain_parameters::ext::credit_referrer_bonus_options& credit_parameters_index::bonus_options( const database& db )const
+    {
+        refresh( db );
+        return _bonus_options;
+    }
+
+    const account_object* credit_parameters_index::special_account( const database& db )const
+    {
+        refresh( db );
+        return find_account( db, _special_account, _bonus_options.special_account_name );
+    }
+
+    const account_object* credit_parameters_index::conversion_account( const database& db )const
+    {
+        static const string name( SPECIAL_CONVERSION_ACCOUNT );
+        return find_account( db, _conversion_account, name );
+    }
+}}
@@ -0,0 +1,188 @@
+#include <graphene/chain/credit_statistics_object.hpp>
+#include <graphene/chain/credit_object.hpp>
+#include <graphene/chain/database.hpp>
+
+namespace graphene { namespace chain
+{
+    credit_statistics_state::credit_statistics_state( const credit_object& credit )
+        : status( credit.status ), borrower( credit.borrower_id( ) ), creditor( credit.creditor_id( ) ),
+          loan( credit.borrower.loan_asset ), deposit( credit.borrower.deposit_asset ),
+          monthly_inflows( credit.monthly_inflows )
+    {
+    }
+
+    credit_totals credit_totals::of( const credit_statistics_state& credit, asset_id_type asset_id )
+    {
+        credit_totals t;
+        bool running = credit.status == e_credit_object_status::wating_for_acceptance ||
+                       credit.status == e_credit_object_status::in_progress;
+
+        if( running && credit.deposit.asset_id == asset_id )
+            t.locked_deposits = credit.deposit.amount;
+
+        if( credit.loan.asset_id != asset_id )
+            return t;
+
+        switch( credit.status )
+        {
+            case e_credit_object_status::wating_for_acceptance:
+                ++t.requests_waiting;
+                break;
+            case e_credit_object_status::in_progress:
+                ++t.credits_in_progress;
+                t.outstanding_principal = credit.loan.amount;
+                break;
+            case e_credit_object_status::complete_normal:
+                ++t.credits_settled;
+                break;
+            case e_credit_object_status::complete_ubnormal:
+                ++t.credits_defaulted;
+                t.defaulted_principal = credit.loan.amount;
+                break;
+            default:
+                break;
+        }
+
+        t.monthly_inflows = credit.monthly_inflows;
+        return t;
+    }
+
+    bool credit_totals::operator == ( const credit_totals& o )const
+    {
+        return outstanding_principal == o.outstanding_principal && locked_deposits == o.locked_deposits &&
+               monthly_inflows == o.monthly_inflows && defaulted_principal == o.defaulted_principal &&
+               requests_waiting == o.requests_waiting && credits_in_progress == o.credits_in_progress &&
+               credits_settled == o.credits_settled && credits_defaulted == o.credits_defaulted;
+    }
+
+    credit_totals& credit_totals::operator += ( const credit_totals& o )
+    {
+        outstanding_principal += o.outstanding_principal;
+        locked_deposits += o.locked_deposits;
+        monthly_inflows += o.monthly_inflows;
+        defaulted_principal += o.defaulted_principal;
+        requests_waiting += o.requests_waiting;
+        credits_in_progress += o.credits_in_progress;
+        credits_settled += o.credits_settled;
+        credits_defaulted += o.credits_defaulted;
+        return *this;
+    }
+
+    credit_totals& credit_totals::operator -= ( const credit_totals& o )
+    {
+        outstanding_principal -= o.outstanding_principal;
+        locked_deposits -= o.locked_deposits;
+        monthly_inflows -= o.monthly_inflows;
+        defaulted_principal -= o.defaulted_principal;
+        requests_waiting -= o.requests_waiting;
+        credits_in_progress -= o.credits_in_progress;
+        credits_settled -= o.credits_settled;
+        credits_defaulted -= o.credits_defaulted;
+        return *this;
+    }
+
+    namespace {
+        optional<account_id_type> credit_creditor( const credit_statistics_state* credit )
+        {
+            if( credit == nullptr || credit->status == e_credit_object_status::wating_for_acceptance ||
+                credit->status == e_credit_object_status::cancalled )
+                return optional<account_id_type>( );
+            return credit->creditor;
+        }
+
+        optional<account_id_type> credit_borrower( const credit_statistics_state* credit )
+        {
+            if( credit == nullptr )
+                return optional<account_id_type>( );
+            return credit->borrower;
+        }
+
+        void adjust_asset_statistics( database& db, asset_id_type asset, const credit_totals& sub, const credit_totals& add )
+        {
+            const auto& idx = db.get_index_type<credit_statistics_index>( ).indices( ).get<by_asset>( );
+            auto itr = idx.find( asset );
+            if( itr == idx.end( ) )
+            {
+                db.create<credit_statistics_object>( [&]( credit_statistics_object& s ) {
+                    s.asset = asset;
+                    s.totals -= sub;
+                    s.totals += add;
+                });
+                return;
+            }
+            db.modify( *itr, [&]( credit_statistics_object& s ) {
+                s.totals -= sub;
+                s.totals += add;
+            });
+        }
+
+        void adjust_account_statistics( database& db, account_id_type account, asset_id_type asset, bool as_borrower,
+                                        const credit_totals& sub, const credit_totals& add )
+        {
+            auto apply = [&]( account_credit_statistics_object& s ) {
+                credit_totals& totals = as_borrower ? s.as_borrower : s.as_creditor;
+                totals -= sub;
+                totals += add;
+            };
+
+            const auto& idx = db.get_index_type<account_credit_statistics_index>( ).indices( ).get<by_account_asset>( );
+            auto itr = idx.find( boost::make_tuple( account, asset ) );
+            if( itr == idx.end( ) )
+            {
+                db.create<account_credit_statistics_object>( [&]( account_credit_statistics_object& s ) {
+                    s.account = account;
+                    s.asset = asset;
+                    apply( s );
+                });
+                return;
+            }
+            db.modify( *itr, apply );
+        }
+
+        void adjust_party_statistics( database& db, asset_id_type asset, bool as_borrower,
+                                      const optional<account_id_type>& party_before, const credit_totals& part_before,
+                                      const optional<account_id_type>& party_after, const credit_totals& part_after )
+        {
+            if( party_before.valid( ) && party_after.valid( ) && *party_before == *party_after )
+            {
+                if( part_before != part_after )
+                    adjust_account_statistics( db, *party_after, asset, as_borrower, part_before, part_after );
+                return;
+            }
+            if( party_before.valid( ) && part_before != credit_totals( ) )
+                adjust_account_statistics( db, *party_before, asset, as_borrower, part_before, credit_totals( ) );
+            if( party_after.valid( ) && part_after != credit_totals( ) )
+                adjust_account_statistics( db, *party_after, asset, as_borrower, credit_totals( ), part_after );
+        }
+
+        void move_credit_statistics( database& db, const credit_statistics_state* before, const credit_statistics_state* after )
+        {
+            flat_set<asset_id_type> assets;
+            for( const credit_statistics_state* credit : { before, after } )
+                if( credit != nullptr )
+                {
+                    assets.insert( credit->loan.asset_id );
+                    assets.insert( credit->deposit.asset_id );
+                }
+
+            for( asset_id_type asset : assets )
+            {
+                credit_totals part_before = before ? credit_totals::of( *before, asset ) : credit_totals( );
+                credit_totals part_after = after ? credit_totals::of( *after, asset ) : credit_totals( );
+
+                if( part_before != part_after )
+                    adjust_asset_statistics( db, asset, part_before, part_after );
+                adjust_party_statistics( db, asset, true, credit_borrower( before ), part_before, credit_borrower( after ), part_after );
+                adjust_party_statistics( db, asset, false, credit_creditor( before ), part_before, credit_creditor( after ), part_after );
+            }
+        }
+    }
+
+    void update_credit_statistics( database& db, const credit_statistics_state* before, const credit_object* after )
+    {
+        if( after == nullptr )
+            return move_credit_statistics( db, before, nullptr );
+        credit_statistics_state now( *after );
+        move_credit_statistics( db, before, &now );
+    }
+} }
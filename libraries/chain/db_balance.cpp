@@ -76,6 +76,9 @@ void database::adjust_balance(account_id_type account, asset delta )
       });
    }
 
+   if( delta.amount > 0 && _credit_pass_funded != nullptr )
+      _credit_pass_funded->emplace( account, delta.asset_id );
+
 } FC_CAPTURE_AND_RETHROW( (account)(delta) ) }
 
 optional< vesting_balance_id_type > database::deposit_lazy_vesting(
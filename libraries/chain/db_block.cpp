@@ -33,6 +33,7 @@
 #include <graphene/chain/proposal_object.hpp>
 #include <graphene/chain/transaction_object.hpp>
 #include <graphene/chain/witness_object.hpp>
+#include <graphene/chain/credit_object.hpp>
 #include <graphene/chain/protocol/fee_schedule.hpp>
 #include <graphene/chain/exceptions.hpp>
 #include <graphene/chain/evaluator.hpp>
@@ -464,7 +465,8 @@ const vector<optional< operation_history_object > >& database::get_applied_opera
 
 //////////////////// private methods ////////////////////
 
-void database::apply_block( const signed_block& next_block, uint32_t skip )
+void database::apply_block( const signed_block& next_block, uint32_t skip,
+                            const vector<recovered_signature_keys>* signature_keys, bool fresh_digests )
 {
    auto block_num = next_block.block_num();
    if( _checkpoints.size() && _checkpoints.rbegin()->second != block_id_type() )
@@ -479,17 +481,24 @@ void database::apply_block( const signed_block& next_block, uint32_t skip )
 
    detail::with_skip_flags( *this, skip, [&]()
    {
-      _apply_block( next_block );
+      _apply_block( next_block, signature_keys, fresh_digests );
    } );
    return;
 }
 
-void database::_apply_block( const signed_block& next_block )
+void database::_apply_block( const signed_block& next_block, const vector<recovered_signature_keys>* prefetched_keys,
+                             bool fresh_digests )
 { try {
    uint32_t next_block_num = next_block.block_num();
    uint32_t skip = get_node_properties().skip_flags;
    _applied_ops.clear();
 
+   // the merkle root, the signature keys and the authority checks below all use the cached digests, which
+   // assigning to a field of a transaction does not drop
+   if( !fresh_digests )
+      for( const auto& trx : next_block.transactions )
+         trx.reset_digests();
+
    FC_ASSERT( (skip & skip_merkle_check) || next_block.transaction_merkle_root == next_block.calculate_merkle_root(), "", ("next_block.transaction_merkle_root",next_block.transaction_merkle_root)("calc",next_block.calculate_merkle_root())("next_block",next_block)("id",next_block.id()) );
 
    const witness_object& signing_witness = validate_block_header(skip, next_block);
@@ -500,6 +509,24 @@ void database::_apply_block( const signed_block& next_block )
    _current_block_num    = next_block_num;
    _current_trx_in_block = 0;
 
+   // the signature keys of all transactions are recovered at once, before the transactions are applied in order
+   vector<recovered_signature_keys> recovered_keys;
+   const vector<recovered_signature_keys>* signature_keys = nullptr;
+   if( !(skip & (skip_transaction_signatures | skip_authority_check)) )
+   {
+      if( prefetched_keys != nullptr )
+      {
+         FC_ASSERT( prefetched_keys->size() == next_block.transactions.size(),
+                    "The prefetched signature keys do not belong to this block" );
+         signature_keys = prefetched_keys;
+      }
+      else
+      {
+         recovered_keys = _signature_recovery.recover( next_block.transactions, get_chain_id(), &_signature_key_cache );
+         signature_keys = &recovered_keys;
+      }
+   }
+
    for( const auto& trx : next_block.transactions )
    {
       /* We do not need to push the undo state for each transaction
@@ -508,7 +535,8 @@ void database::_apply_block( const signed_block& next_block )
        * for transactions when validating broadcast transactions or
        * when building a block.
        */
-      apply_transaction( trx, skip );
+      trx.precompute_digests( get_chain_id() );
+      _apply_transaction( trx, signature_keys != nullptr ? &(*signature_keys)[_current_trx_in_block] : nullptr, true );
       ++_current_trx_in_block;
    }
 
@@ -529,6 +557,9 @@ void database::_apply_block( const signed_block& next_block )
    process_credit_stories();
    process_exchange_rates();
 
+   if( _undo_db.enabled() )
+      _last_block_credit_undo_clones = _undo_db.cloned_objects( credit_object::space_id, credit_object::type_id );
+
    // n.b., update_maintenance_flag() happens this late
    // because get_slot_time() / get_slot_at_time() is needed above
    // TODO:  figure out if we could collapse this function into
@@ -558,7 +589,8 @@ processed_transaction database::apply_transaction(const signed_transaction& trx,
    return result;
 }
 
-processed_transaction database::_apply_transaction(const signed_transaction& trx)
+processed_transaction database::_apply_transaction( const signed_transaction& trx,
+                                                    const recovered_signature_keys* signature_keys, bool fresh_digests )
 { try {
    uint32_t skip = get_node_properties().skip_flags;
 
@@ -567,7 +599,13 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
 
    auto& trx_idx = get_mutable_index_type<transaction_index>();
    const chain_id_type& chain_id = get_chain_id();
-   auto trx_id = trx.id();
+   // the copy kept in the result hashes the transaction once. Only fresh digests are kept, those of other
+   // callers may predate an assignment to the fields
+   processed_transaction ptrx(trx);
+   if( !fresh_digests )
+      ptrx.reset_digests();
+   ptrx.precompute_digests( chain_id );
+   auto trx_id = ptrx.id();
    FC_ASSERT( (skip & skip_transaction_dupe_check) ||
               trx_idx.indices().get<by_trx_id>().find(trx_id) == trx_idx.indices().get<by_trx_id>().end() );
    transaction_evaluation_state eval_state(this);
@@ -578,7 +616,12 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    {
       auto get_active = [&]( account_id_type id ) { return &id(*this).active; };
       auto get_owner  = [&]( account_id_type id ) { return &id(*this).owner;  };
-      trx.verify_authority( chain_id, get_active, get_owner, get_global_properties().parameters.max_authority_depth );
+      if( signature_keys != nullptr )
+         graphene::chain::verify_authority( trx.operations, signature_keys->get(), get_active, get_owner,
+                                            get_global_properties().parameters.max_authority_depth );
+      else
+         graphene::chain::verify_authority( trx.operations, ptrx.get_signature_keys( chain_id, &_signature_key_cache ),
+                                            get_active, get_owner, get_global_properties().parameters.max_authority_depth );
    }
 
    //Skip all manner of expiration and TaPoS checking if we're on block 1; It's impossible that the transaction is
@@ -612,7 +655,6 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    eval_state.operation_results.reserve(trx.operations.size());
 
    //Finally process the operations
-   processed_transaction ptrx(trx);
    _current_op_in_trx = 0;
    for( const auto& op : ptrx.operations )
    {
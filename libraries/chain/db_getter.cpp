@@ -26,6 +26,7 @@
 
 #include <graphene/chain/asset_object.hpp>
 #include <graphene/chain/chain_property_object.hpp>
+#include <graphene/chain/credit_object.hpp>
 #include <graphene/chain/global_property_object.hpp>
 
 #include <fc/smart_ref_impl.hpp>
@@ -77,6 +78,26 @@ decltype( chain_parameters::block_interval ) database::block_interval( )const
    return get_global_properties().parameters.block_interval;
 }
 
+const chain_parameters::ext::credit_options& database::get_credit_options()const
+{
+   return _credit_parameters->credit_options( *this );
+}
+
+const chain_parameters::ext::credit_referrer_bonus_options& database::get_bonus_options()const
+{
+   return _credit_parameters->bonus_options( *this );
+}
+
+const account_object* database::find_special_account()const
+{
+   return _credit_parameters->special_account( *this );
+}
+
+const account_object* database::find_conversion_account()const
+{
+   return _credit_parameters->conversion_account( *this );
+}
+
 const chain_id_type& database::get_chain_id( )const
 {
    return get_chain_properties().chain_id;
@@ -47,6 +47,7 @@
 #include <graphene/chain/witness_schedule_object.hpp>
 #include <graphene/chain/worker_object.hpp>
 #include <graphene/chain/credit_object.hpp>
+#include <graphene/chain/credit_statistics_object.hpp>
 #include <graphene/chain/exchange_rate_object.hpp>
 
 #include <graphene/chain/account_evaluator.hpp>
@@ -96,9 +97,21 @@ const uint8_t credit_object::type_id;
 const uint8_t exchange_rate_object::space_id;
 const uint8_t exchange_rate_object::type_id;
 
+const uint8_t exchange_rate_votes_object::space_id;
+const uint8_t exchange_rate_votes_object::type_id;
+
 const uint8_t account_history_of_karma_object::space_id;
 const uint8_t account_history_of_karma_object::type_id;
 
+const uint8_t karma_history_entry_object::space_id;
+const uint8_t karma_history_entry_object::type_id;
+
+const uint8_t credit_statistics_object::space_id;
+const uint8_t credit_statistics_object::type_id;
+
+const uint8_t account_credit_statistics_object::space_id;
+const uint8_t account_credit_statistics_object::type_id;
+
 const uint8_t asset_object::space_id;
 const uint8_t asset_object::type_id;
 
@@ -204,12 +217,14 @@ void database::initialize_indexes()
    add_index< primary_index<asset_index> >();
    add_index< primary_index<force_settlement_index> >();
    add_index< primary_index<credit_index> >();
-   add_index< primary_index<exchange_rate_index> >();
+   auto rate_index = add_index< primary_index<exchange_rate_index> >();
+   rate_index->add_secondary_index<exchange_rate_table_index>();
    add_index< primary_index<account_history_of_karma_index> >();
 
    auto acnt_index = add_index< primary_index<account_index> >();   
    acnt_index->add_secondary_index<account_member_index>();
    acnt_index->add_secondary_index<account_referrer_index>();
+   acnt_index->add_secondary_index<account_karma_index>();
 
    add_index< primary_index<committee_member_index> >();
    add_index< primary_index<witness_index> >();
@@ -229,7 +244,8 @@ void database::initialize_indexes()
    add_index< primary_index<transaction_index                             > >();
    add_index< primary_index<account_balance_index                         > >();
    add_index< primary_index<asset_bitasset_data_index                     > >();
-   add_index< primary_index<simple_index<global_property_object          >> >();
+   auto gpo_index = add_index< primary_index<simple_index<global_property_object          >> >();
+   _credit_parameters = gpo_index->add_secondary_index<credit_parameters_index>();
    add_index< primary_index<simple_index<dynamic_global_property_object  >> >();
    add_index< primary_index<simple_index<account_statistics_object       >> >();
    add_index< primary_index<simple_index<asset_dynamic_data_object       >> >();
@@ -240,8 +256,17 @@ void database::initialize_indexes()
    add_index< primary_index< special_authority_index                      > >();
    add_index< primary_index< buyback_index                                > >();
    add_index< primary_index<collateral_bid_index                          > >();
+   add_index< primary_index<karma_history_entry_index                     > >();
+   add_index< primary_index<exchange_rate_votes_index                     > >();
+   add_index< primary_index<credit_statistics_index                       > >();
+   add_index< primary_index<account_credit_statistics_index               > >();
 
    add_index< primary_index< simple_index< fba_accumulator_object       > > >();
+
+   // large objects of which a block usually changes a few fields
+   _undo_db.store_deltas( account_object::space_id, account_object::type_id );
+   _undo_db.store_deltas( credit_object::space_id, credit_object::type_id );
+   _undo_db.store_deltas( exchange_rate_object::space_id, exchange_rate_object::type_id );
 }
 
 void database::init_genesis(const genesis_state_type& genesis_state)
@@ -893,6 +893,9 @@ void database::perform_chain_maintenance(const signed_block& next_block, const g
    update_active_committee_members();
    update_worker_votes();
 
+   const uint32_t old_seconds_per_day = gpo.parameters.get_credit_options().seconds_per_day;
+   const uint32_t old_max_expiration_days = gpo.parameters.get_credit_options().max_credit_expiration_days;
+
    modify(gpo, [this](global_property_object& p) {
       // Remove scaling of account registration fee
       const auto& dgpo = get_dynamic_global_properties();
@@ -944,6 +947,17 @@ void database::perform_chain_maintenance(const signed_block& next_block, const g
       }
    });
 
+   // payment dates and overdue deadlines of running credits are measured in credit days
+   if( gpo.parameters.get_credit_options().seconds_per_day != old_seconds_per_day ||
+       gpo.parameters.get_credit_options().max_credit_expiration_days != old_max_expiration_days )
+   {
+      const auto& credits = get_index_type<credit_index>().indices().get<by_status>();
+      auto range = credits.equal_range( boost::make_tuple( e_credit_object_status::in_progress ) );
+      for( auto itr = range.first; itr != range.second; ++itr )
+         if( itr->next_process_time > head_block_time() )
+            modify( *itr, [this]( credit_object& c ) { c.schedule_next_process( *this ); } );
+   }
+
    auto next_maintenance_time = get<dynamic_global_property_object>(dynamic_global_property_id_type()).next_maintenance_time;
    auto maintenance_interval = gpo.parameters.maintenance_interval;
 
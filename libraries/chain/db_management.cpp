@@ -24,6 +24,7 @@
 
 #include <graphene/chain/database.hpp>
 
+#include <graphene/chain/block_prefetcher.hpp>
 #include <graphene/chain/operation_history_object.hpp>
 #include <graphene/chain/protocol/fee_schedule.hpp>
 
@@ -32,9 +33,33 @@
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <memory>
 
 namespace graphene { namespace chain {
 
+/// the first field of a chain state snapshot, see @ref database::save_snapshot
+static const char* snapshot_magic = "KRM-SNAPSHOT";
+
+/// @return the head block stored in the header of @p snapshot, without checking the rest of the file
+static optional<signed_block> snapshot_head_block( const fc::path& snapshot )
+{ try {
+   FC_ASSERT( fc::exists( snapshot ), "Snapshot not found" );
+   fc::file_mapping fm( snapshot.generic_string().c_str(), fc::read_only );
+   fc::mapped_region mr( fm, fc::read_only, 0, fc::file_size( snapshot ) );
+   fc::datastream<const char*> ds( (const char*)mr.get_address(), mr.get_size() );
+
+   std::string magic;
+   std::string version;
+   chain_id_type chain_id;
+   optional<signed_block> head_block;
+   fc::raw::unpack( ds, magic );
+   FC_ASSERT( magic == snapshot_magic, "Not a chain state snapshot" );
+   fc::raw::unpack( ds, version );
+   fc::raw::unpack( ds, chain_id );
+   fc::raw::unpack( ds, head_block );
+   return head_block;
+} FC_CAPTURE_AND_RETHROW( (snapshot) ) }
+
 database::database()
 {
    initialize_indexes();
@@ -57,6 +82,8 @@ void database::reindex( fc::path data_dir )
    if( last_block->block_num() <= head_block_num()) return;
 
    ilog( "reindexing blockchain" );
+   if( _replay_check_signatures )
+      ilog( "Signatures will be checked" );
    auto start = fc::time_point::now();
    const auto last_block_num = last_block->block_num();
    uint32_t flush_point = last_block_num < 10000 ? 0 : last_block_num - 10000;
@@ -70,6 +97,18 @@ void database::reindex( fc::path data_dir )
    }
    else
       _undo_db.disable();
+
+   // the blocks applied without undo history are read and checked ahead by other threads, the prefetcher is
+   // gone before push_block writes to the block database
+   std::unique_ptr<block_prefetcher> prefetcher;
+   if( head_block_num() + 1 < undo_point )
+      prefetcher.reset( new block_prefetcher( _block_id_to_block, head_block_num() + 1, undo_point - 1,
+                                              get_chain_id(), _replay_check_signatures ) );
+
+   uint32_t signature_skip = _replay_check_signatures ? 0 : skip_witness_signature |
+                                                            skip_transaction_signatures |
+                                                            skip_authority_check;
+
    for( uint32_t i = head_block_num() + 1; i <= last_block_num; ++i )
    {
       if( i % 10000 == 0 ) std::cerr << "   " << double(i*100)/last_block_num << "%   "<<i << " of " <<last_block_num<<"   \n";
@@ -79,9 +118,27 @@ void database::reindex( fc::path data_dir )
          flush();
          ilog( "Done" );
       }
-      fc::optional< signed_block > block = _block_id_to_block.fetch_by_number(i);
+      fc::optional< signed_block > block;
+      vector<recovered_signature_keys> signature_keys;
+      uint32_t merkle_skip = 0;
+      if( i < undo_point )
+      {
+         auto prefetched = prefetcher->next();
+         if( prefetched.valid() )
+         {
+            block = std::move( prefetched->block );
+            merkle_skip = prefetched->merkle_checked ? skip_merkle_check : 0;
+            signature_keys = std::move( prefetched->signature_keys );
+         }
+      }
+      else
+      {
+         prefetcher.reset();
+         block = _block_id_to_block.fetch_by_number(i);
+      }
       if( !block.valid() )
       {
+         prefetcher.reset();
          wlog( "Reindexing terminated due to gap:  Block ${i} does not exist!", ("i", i) );
          uint32_t dropped_count = 0;
          while( true )
@@ -100,21 +157,19 @@ void database::reindex( fc::path data_dir )
          break;
       }
       if( i < undo_point )
-         apply_block(*block, skip_witness_signature |
-                             skip_transaction_signatures |
+         apply_block(*block, merkle_skip |
+                             signature_skip |
                              skip_transaction_dupe_check |
                              skip_tapos_check |
-                             skip_witness_schedule_check |
-                             skip_authority_check);
+                             skip_witness_schedule_check,
+                     _replay_check_signatures ? &signature_keys : nullptr, true);
       else
       {
          _undo_db.enable();
-         push_block(*block, skip_witness_signature |
-                            skip_transaction_signatures |
+         push_block(*block, signature_skip |
                             skip_transaction_dupe_check |
                             skip_tapos_check |
-                            skip_witness_schedule_check |
-                            skip_authority_check);
+                            skip_witness_schedule_check);
       }
    }
    _undo_db.enable();
@@ -134,7 +189,8 @@ void database::wipe(const fc::path& data_dir, bool include_blocks)
 void database::open(
    const fc::path& data_dir,
    std::function<genesis_state_type()> genesis_loader,
-   const std::string& db_version)
+   const std::string& db_version,
+   const fc::path& snapshot )
 {
    try
    {
@@ -147,6 +203,29 @@ void database::open(
          fc::read_file_contents( data_dir / "db_version", version_string );
          wipe_object_db = ( version_string != db_version );
       }
+
+      _block_id_to_block.open(data_dir / "database" / "block_num_to_block");
+
+      bool load = snapshot != fc::path();
+      if( load )
+      {
+         optional<signed_block> snapshot_head = snapshot_head_block( snapshot );
+         if( snapshot_head.valid() && _block_id_to_block.last_id().valid() )
+         {
+            // the blocks of the operator are never dropped for a snapshot of another chain or fork
+            FC_ASSERT( _block_id_to_block.contains( snapshot_head->id() ),
+                       "The block database does not hold block ${n} of the snapshot, move ${d} away to start a new one "
+                       "from the snapshot", ("n",snapshot_head->block_num())("d",data_dir / "database") );
+            // a restart with the snapshot still configured goes on from the stored objects
+            if( !wipe_object_db && fc::exists( data_dir / "object_database" ) )
+            {
+               ilog( "Not loading snapshot ${s}, the object database was already started from block ${n}",
+                     ("s",snapshot)("n",snapshot_head->block_num()) );
+               load = false;
+            }
+         }
+      }
+
       if( wipe_object_db ) {
           ilog("Wiping object_database due to missing or wrong version");
           object_database::wipe( data_dir );
@@ -155,10 +234,16 @@ void database::open(
           version_file.write( db_version.c_str(), db_version.size() );
           version_file.close();
       }
+      else if( load )
+      {
+          ilog( "Wiping object_database to start from snapshot ${s}", ("s",snapshot) );
+          object_database::wipe( data_dir );
+      }
 
       object_database::open(data_dir);
 
-      _block_id_to_block.open(data_dir / "database" / "block_num_to_block");
+      if( load )
+         load_snapshot( snapshot, genesis_loader().compute_chain_id() );
 
       if( !find(global_property_id_type()) )
          init_genesis(genesis_loader());
@@ -172,9 +257,98 @@ void database::open(
          reindex( data_dir );
       }
    }
-   FC_CAPTURE_LOG_AND_RETHROW( (data_dir) )
+   FC_CAPTURE_LOG_AND_RETHROW( (data_dir)(snapshot) )
 }
 
+/**
+ * The snapshot holds the magic, the database version, the chain id, the head block if there is one and then the
+ * indexes as written by object_database::save_snapshot, followed by the checksum of index_file_writer.
+ */
+void database::save_snapshot( const fc::path& file )const
+{ try {
+   // a reversible head block may still be popped, the blocks replayed without undo history are final
+   uint32_t last_irreversible = get_dynamic_global_properties().last_irreversible_block_num;
+   FC_ASSERT( !_undo_db.enabled() || head_block_num() <= last_irreversible,
+              "Block ${n} is still reversible, snapshots are only written of irreversible blocks or while replaying",
+              ("n",head_block_num())("last_irreversible",last_irreversible) );
+   write_snapshot( file, pack_snapshot() );
+} FC_CAPTURE_AND_RETHROW( (file) ) }
+
+vector<char> database::pack_snapshot()const
+{ try {
+   ilog( "Packing snapshot of block ${n}", ("n",head_block_num()) );
+   optional<signed_block> head_block;
+   if( head_block_num() > 0 )
+   {
+      head_block = fetch_block_by_id( head_block_id() );
+      FC_ASSERT( head_block.valid(), "The head block is not stored" );
+   }
+
+   vector<char> content;
+   graphene::db::index_file_writer out( content );
+   fc::raw::pack( out, std::string( snapshot_magic ) );
+   fc::raw::pack( out, std::string( GRAPHENE_CURRENT_DB_VERSION ) );
+   fc::raw::pack( out, get_chain_id() );
+   fc::raw::pack( out, head_block );
+   object_database::save_snapshot( out );
+   out.finish();
+   return content;
+} FC_CAPTURE_AND_RETHROW() }
+
+void database::write_snapshot( const fc::path& file, const vector<char>& content )
+{ try {
+   ilog( "Writing snapshot to ${f}", ("f",file) );
+   const fc::path tmp( file.generic_string() + ".tmp" );
+   std::ofstream out( tmp.generic_string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+   FC_ASSERT( out, "Unable to write ${f}", ("f",tmp) );
+   out.write( content.data(), content.size() );
+   out.close();
+   FC_ASSERT( !out.fail(), "Unable to write ${f}", ("f",tmp) );
+   fc::rename( tmp, file );
+   ilog( "Done writing snapshot" );
+} FC_CAPTURE_AND_RETHROW( (file) ) }
+
+void database::load_snapshot( const fc::path& snapshot, const chain_id_type& chain_id )
+{ try {
+   ilog( "Loading snapshot ${s} ...", ("s",snapshot) );
+   FC_ASSERT( fc::exists( snapshot ), "Snapshot not found" );
+   fc::file_mapping fm( snapshot.generic_string().c_str(), fc::read_only );
+   fc::mapped_region mr( fm, fc::read_only, 0, fc::file_size( snapshot ) );
+   fc::datastream<const char*> ds = graphene::db::checked_index_file( snapshot, mr );
+
+   std::string magic;
+   std::string version;
+   chain_id_type snapshot_chain_id;
+   optional<signed_block> head_block;
+   fc::raw::unpack( ds, magic );
+   FC_ASSERT( magic == snapshot_magic, "Not a chain state snapshot" );
+   fc::raw::unpack( ds, version );
+   FC_ASSERT( version == GRAPHENE_CURRENT_DB_VERSION, "The snapshot was written with another database version",
+              ("version",version)("expected",GRAPHENE_CURRENT_DB_VERSION) );
+   fc::raw::unpack( ds, snapshot_chain_id );
+   FC_ASSERT( snapshot_chain_id == chain_id, "The snapshot belongs to another chain",
+              ("chain_id",snapshot_chain_id)("expected",chain_id) );
+   fc::raw::unpack( ds, head_block );
+   object_database::load_snapshot( ds );
+   FC_ASSERT( head_block.valid() ? head_block->id() == head_block_id() : head_block_num() == 0,
+              "The head block of the snapshot does not match its state" );
+
+   // the fork database and the replay of the later blocks start from the head block, an empty block database
+   // starts with it, open refused any other block database that does not hold it
+   if( head_block.valid() && !_block_id_to_block.contains( head_block_id() ) )
+   {
+      FC_ASSERT( !_block_id_to_block.last_id().valid(), "The block database does not hold block ${n} of the snapshot",
+                 ("n",head_block_num()) );
+      ilog( "Starting the block database with block ${n} of the snapshot", ("n",head_block_num()) );
+      _block_id_to_block.store( head_block_id(), *head_block );
+      _block_id_to_block.flush();
+   }
+
+   // saved right away, so that a restart opens the loaded state instead of the genesis state
+   flush();
+   ilog( "Done loading snapshot of block ${n}", ("n",head_block_num()) );
+} FC_CAPTURE_AND_RETHROW( (snapshot) ) }
+
 void database::close(bool rewind)
 {
    // TODO:  Save pending tx's on close()
@@ -9,6 +9,9 @@
 #include <graphene/chain/confidential_object.hpp>
 #include <graphene/chain/market_object.hpp>
 #include <graphene/chain/committee_member_object.hpp>
+#include <graphene/chain/credit_object.hpp>
+#include <graphene/chain/credit_statistics_object.hpp>
+#include <graphene/chain/exchange_rate_object.hpp>
 
 using namespace fc;
 using namespace graphene::chain;
@@ -313,10 +316,21 @@ static void get_relevant_accounts( const object* obj, flat_set<account_id_type>&
            /** these are free from any accounts */
            break;
         } case credit_object_type:{
+           const auto& aobj = dynamic_cast<const credit_object*>(obj);
+           assert( aobj != nullptr );
+           accounts.insert( aobj->borrower_id() );
+           /** the creditor is only known once the request is approved */
+           if( aobj->status != e_credit_object_status::wating_for_acceptance &&
+               aobj->status != e_credit_object_status::cancalled )
+              accounts.insert( aobj->creditor_id() );
            break;
         } case exchange_rate_object_type:{
+           /** published rates are free from any accounts */
            break;
         } case account_history_of_karma_object_type:{
+           const auto& aobj = dynamic_cast<const account_history_of_karma_object*>(obj);
+           assert( aobj != nullptr );
+           accounts.insert( aobj->account );
            break;
         }
       }
@@ -377,6 +391,24 @@ static void get_relevant_accounts( const object* obj, flat_set<account_id_type>&
               assert( aobj != nullptr );
               accounts.insert( aobj->bidder );
               break;
+           } case impl_karma_history_entry_object_type:{
+              const auto& aobj = dynamic_cast<const karma_history_entry_object*>(obj);
+              assert( aobj != nullptr );
+              accounts.insert( aobj->account );
+              break;
+           } case impl_exchange_rate_votes_object_type:{
+              const auto& aobj = dynamic_cast<const exchange_rate_votes_object*>(obj);
+              assert( aobj != nullptr );
+              for( const auto& vote : aobj->votes )
+                accounts.insert( vote.first );
+              break;
+           } case impl_credit_statistics_object_type:
+              break;
+             case impl_account_credit_statistics_object_type:{
+              const auto& aobj = dynamic_cast<const account_credit_statistics_object*>(obj);
+              assert( aobj != nullptr );
+              accounts.insert( aobj->account );
+              break;
            }
       }
    }
@@ -416,6 +448,13 @@ void database::notify_changed_objects()
           changed_ids.push_back(item.first);
           get_relevant_accounts(item.second.get(), changed_accounts_impacted);
         }
+        for( const auto& item : head_undo.old_deltas )
+        {
+          changed_ids.push_back(item.first);
+          auto obj = find_object(item.first);
+          if(obj != nullptr)
+            get_relevant_accounts(obj, changed_accounts_impacted);
+        }
 
         changed_objects(changed_ids, changed_accounts_impacted);
       }
@@ -34,12 +34,19 @@
 #include <graphene/chain/withdraw_permission_object.hpp>
 #include <graphene/chain/witness_object.hpp>
 #include <graphene/chain/credit_object.hpp>
+#include <graphene/chain/credit_statistics_object.hpp>
 #include <graphene/chain/exchange_rate_object.hpp>
 
 #include <graphene/chain/protocol/fee_schedule.hpp>
 
 #include <fc/uint128.hpp>
 
+#include <boost/scope_exit.hpp>
+
+#include <algorithm>
+#include <set>
+#include <tuple>
+
 namespace graphene { namespace chain {
 
 void database::update_global_dynamic_data( const signed_block& b )
@@ -258,24 +265,132 @@ bool database::check_for_blackswan( const asset_object& mia, bool enable_black_s
 
 void database::process_credit_stories( )
 {
-   auto& e = get_index_type<credit_index>( ).indices( ).get<by_request_creation_time>( );
-   for( auto itr = e.begin( ); itr != e.end( ); itr++ )
+   const auto& credits = get_index_type<credit_index>( ).indices( );
+   const time_point_sec now = head_block_time( );
+
+   vector<const credit_object*> due;
+   const auto& by_time = credits.get<by_next_process_time>( );
+   for( auto itr = by_time.begin( ); itr != by_time.end( ) && itr->next_process_time <= now; ++itr )
+      due.push_back( &*itr );
+
+   // rates published by the previous block may have pushed deposits below their margin, per asset pair only
+   // the least collateralized credits up to the new threshold can be affected
+   const auto& rates = *get_index_type<exchange_rate_index>( ).indices( ).get<by_id>( ).begin( );
+   if( rates.last_update_block_num + 1 == head_block_num( ) )
    {
-      modify( *itr, [this]( credit_object& b ) 
+      const auto& by_collateral = credits.get<by_collateralization>( );
+      auto itr = by_collateral.lower_bound( boost::make_tuple( true ) );
+      while( itr != by_collateral.end( ) )
       {
-        b.process( this );
-      });
+         const asset_object& deposit = itr->borrower.deposit_asset.asset_id( *this );
+         const asset_object& loan = itr->borrower.loan_asset.asset_id( *this );
+         auto pair_end = by_collateral.upper_bound( boost::make_tuple( true,
+                            price{ asset( GRAPHENE_MAX_SHARE_SUPPLY, deposit.id ), asset( 1, loan.id ) } ) );
+
+         // deposit_covers_loan in raw amounts, widened so rounding never hides a credit from the exact check
+         double threshold = ( DEPOSIT_PERSENT / 2 ) / 100.0 * get_exchange_rate( *this, loan ) / get_exchange_rate( *this, deposit )
+                          * asset::real_scaled_precision( deposit.precision ) / asset::real_scaled_precision( loan.precision )
+                          * ( 1 + 1e-6 );
+
+         for( ; itr != pair_end; ++itr )
+         {
+            if( double( itr->borrower.deposit_asset.amount.value ) / double( itr->borrower.loan_asset.amount.value ) > threshold )
+               break;
+            if( itr->next_process_time > now && itr->needs_processing( *this ) )
+               due.push_back( &*itr );
+         }
+         itr = pair_end;
+      }
+   }
+
+   // overdue credits wait for their deadline, or for their borrower to receive the loan asset
+   const auto& overdue = credits.get<by_overdue_borrower>( );
+   for( auto itr = overdue.lower_bound( boost::make_tuple( true ) ); itr != overdue.end( ); ++itr )
+      if( itr->next_process_time > now && itr->borrower_can_pay( *this ) )
+         due.push_back( &*itr );
+
+   // settle in creation order, as a full scan would, since credits of one borrower share balances
+   auto creation_order = []( const credit_object* a, const credit_object* b ) {
+      return std::tie( a->request_creation_time, a->id ) < std::tie( b->request_creation_time, b->id );
+   };
+   std::set<const credit_object*, decltype( creation_order )> worklist( due.begin( ), due.end( ), creation_order );
+
+   flat_set<std::pair<account_id_type,asset_id_type>> funded;
+   _credit_pass_funded = &funded;
+   BOOST_SCOPE_EXIT(this_) {
+      this_->_credit_pass_funded = nullptr;
+   } BOOST_SCOPE_EXIT_END
+
+   while( !worklist.empty( ) )
+   {
+      const credit_object* c = *worklist.begin( );
+      worklist.erase( worklist.begin( ) );
+
+      if( c->needs_processing( *this ) )
+      {
+         credit_statistics_state before( *c );
+         modify( *c, [this]( credit_object& b ) 
+         {
+           b.process( this );
+         });
+         update_credit_statistics( *this, &before, c );
+      }
+      else if( c->next_process_time <= now )
+      {
+         // nothing changes before the next payment, deadline or funding of the borrower
+         time_point_sec next = c->scheduled_process_time( *this );
+         if( next != c->next_process_time )
+            modify( *c, [next]( credit_object& b ) { b.next_process_time = next; } );
+      }
+
+      // overdue credits funded by this settlement are looked at in this pass when they come later in creation
+      // order, the scan of the next block finds the others
+      for( const auto& balance : funded )
+      {
+         auto range = overdue.equal_range( boost::make_tuple( true, balance.first, balance.second ) );
+         for( auto itr = range.first; itr != range.second; ++itr )
+            if( creation_order( c, &*itr ) )
+               worklist.insert( &*itr );
+      }
+      funded.clear( );
    }
 }
 
 void database::process_exchange_rates( )
 {
-   const auto& e = get_index_type<exchange_rate_index>( ).indices( ).get<by_id>( );
-      
-   modify( *e.begin(), [this]( exchange_rate_object& b ) 
+   const auto& options = get_credit_options();
+   uint32_t now = head_block_time( ).sec_since_epoch( );
+   if( now < options.exchange_rate_set_min_interval )
+      return;
+
+   // only symbols whose minimal interval elapsed since the last check are due
+   const auto& votes_by_check_time = get_index_type<exchange_rate_votes_index>( ).indices( ).get<by_last_check_time>( );
+   auto due_end = votes_by_check_time.upper_bound( boost::make_tuple( now - options.exchange_rate_set_min_interval ) );
+   vector<const exchange_rate_votes_object*> due;
+   for( auto itr = votes_by_check_time.begin( ); itr != due_end; ++itr )
+      due.push_back( &*itr );
+
+   const exchange_rate_object& rates = *get_index_type<exchange_rate_index>( ).indices( ).get<by_id>( ).begin( );
+   for( const exchange_rate_votes_object* votes : due )
+   {
+      if( votes->votes.size( ) >= options.min_witnesses_for_exchange_rate )
       {
-        b.process( this );
-      });   
+         double median = votes->median( );
+         modify( rates, [&]( exchange_rate_object& b )
+         {
+            b.last_exchange_rate[votes->symbol] = median;
+            b.last_update_block_num = head_block_num( );
+         });
+         remove( *votes );
+      }
+      else if( now - votes->first_vote_time >= options.exchange_rate_set_max_interval )
+         remove( *votes );
+      else
+         modify( *votes, [now]( exchange_rate_votes_object& v )
+         {
+            v.last_check_time = now;
+         });
+   }
 }
 
 void database::clear_expired_orders()
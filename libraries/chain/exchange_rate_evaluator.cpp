@@ -77,23 +77,33 @@ void_result exchange_rate_set_evaluator::do_apply( const exchange_rate_set_opera
 { 
    try {          
    
-        const auto& e = db( ).get_index_type<exchange_rate_index>( ).indices( ).get<by_id>( );
-   
-        db( ).modify( *e.begin(), [this,&op]( exchange_rate_object& b ) 
+        database& d = db( );
+        const auto& votes_by_symbol = d.get_index_type<exchange_rate_votes_index>( ).indices( ).get<by_symbol>( );
+        uint32_t now = d.head_block_time( ).sec_since_epoch( );
+
+        for(auto it_new_exchange_rates = op.exchange_rate.begin(); it_new_exchange_rates != op.exchange_rate.end(); it_new_exchange_rates ++)
         {
-            for(auto it_new_exchange_rates = op.exchange_rate.begin(); it_new_exchange_rates != op.exchange_rate.end(); it_new_exchange_rates ++)
-            {
-                b.current_exchange_rate[it_new_exchange_rates->first][op.witness] = it_new_exchange_rates->second;
+            auto it_votes = votes_by_symbol.find(it_new_exchange_rates->first);
 
-                // is this the first set for this currancy?    
-                auto it_exchange_rate_interval = b.current_exchange_rate_interval.find(it_new_exchange_rates->first);
-                if(it_exchange_rate_interval == b.current_exchange_rate_interval.end())
+            // is this the first set for this currancy?    
+            if(it_votes == votes_by_symbol.end())
+            {
+                d.create<exchange_rate_votes_object>( [&]( exchange_rate_votes_object& v )
+                {
+                    v.symbol = it_new_exchange_rates->first;
+                    v.first_vote_time = now;
+                    v.last_check_time = now;
+                    v.set_vote( op.witness, it_new_exchange_rates->second );
+                });
+            }
+            else
+            {
+                d.modify( *it_votes, [&]( exchange_rate_votes_object& v )
                 {
-                    std::pair<double, double> pair_intervals(db( ).head_block_time( ).sec_since_epoch( ),db( ).head_block_time( ).sec_since_epoch( ));
-                    b.current_exchange_rate_interval[it_new_exchange_rates->first] = pair_intervals;
-                }
-            }    
-        });
+                    v.set_vote( op.witness, it_new_exchange_rates->second );
+                });
+            }
+        }    
 
         return void_result();
 
@@ -4,61 +4,36 @@
 #include <graphene/chain/hardfork.hpp>
 #include <fc/uint128.hpp>
 
+#include <algorithm>
+
 
 namespace graphene { namespace chain 
 {
-    void exchange_rate_object::process( graphene::chain::database* db )
-    {       
-        uint32_t min_interval_period = db->get_global_properties().parameters.get_credit_options().exchange_rate_set_min_interval;
-        uint32_t max_interval_period = db->get_global_properties().parameters.get_credit_options().exchange_rate_set_max_interval;
-        uint32_t min_witnesses = db->get_global_properties().parameters.get_credit_options().min_witnesses_for_exchange_rate;
-        
-        uint32_t now_time = db->head_block_time( ).sec_since_epoch( );
-        
-        // do we have new_exchange_rates for which its time to check?
-        for(auto it_interval = current_exchange_rate_interval.begin(); it_interval != current_exchange_rate_interval.end(); it_interval++)
+    void exchange_rate_votes_object::set_vote( account_id_type witness, double rate )
+    {
+        auto itr = votes.find( witness );
+        if( itr != votes.end( ) )
         {
-            //!!! it_interval->second = std::pair<start_time, last_min_interval_check_time>            
-            if(now_time - it_interval->second.second >= min_interval_period)    
-            {
-                uint32_t vec_size = current_exchange_rate[it_interval->first].size();
-                bool set_exchange_rates_flag = false;
-
-                // do we have enough votes for this currancy?
-                if( vec_size >= min_witnesses)
-                {
-                    // calculate new median for this currancy
-                    std::vector<double> currency;
-                    double median;
-
-                    for(auto it = current_exchange_rate[it_interval->first].begin(); it != current_exchange_rate[it_interval->first].end(); it++)
-                        currency.push_back(it->second);
-
-                    std::sort(currency.begin(), currency.end());
-                
-                    if(vec_size%2)
-                        median = currency[vec_size/2];
-                    else
-                        median = (currency[vec_size/2-1]+currency[vec_size/2])/2;
-                    
-                    last_exchange_rate[it_interval->first]=median;
-
-                    set_exchange_rates_flag = true;
-                }
-                else // set new last check time
-                    it_interval->second.second = now_time;
-                
-                if( set_exchange_rates_flag || (now_time - it_interval->second.first >= max_interval_period))
-                {
-                    //clear interval and currant_exchange_rate for this currancy
-                    current_exchange_rate[it_interval->first].clear();
-                    current_exchange_rate_interval.erase(it_interval);
-                }    
-            }
+            sorted_votes.erase( std::lower_bound( sorted_votes.begin( ), sorted_votes.end( ), itr->second ) );
+            itr->second = rate;
         }
+        else
+            votes[witness] = rate;
+
+        sorted_votes.insert( std::upper_bound( sorted_votes.begin( ), sorted_votes.end( ), rate ), rate );
+    }
+
+    double exchange_rate_votes_object::median( )const
+    {
+        size_t size = sorted_votes.size( );
+        FC_ASSERT( size > 0 );
+
+        if( size % 2 )
+            return sorted_votes[size / 2];
+        return ( sorted_votes[size / 2 - 1] + sorted_votes[size / 2] ) / 2;
     }
     
-    double get_exchange_rate_by_symbol( graphene::chain::database* db, std::string symbol)
+    double get_exchange_rate_by_symbol( const graphene::chain::database* db, const std::string& symbol )
     {
         const auto& e = db->get_index_type<exchange_rate_index>( ).indices( ).get<by_id>( );    
 
@@ -67,5 +42,63 @@ namespace graphene { namespace chain
 
         return exchange_rate_itr->second;
     }
-}}
 
+    double get_exchange_rate( const graphene::chain::database& db, const asset_object& asset )
+    {
+        const auto& idx = dynamic_cast<const primary_index<exchange_rate_index>&>( db.get_index_type<exchange_rate_index>( ) );
+        const double* rate = idx.get_secondary_index<exchange_rate_table_index>( ).find( db, asset );
+        if( rate != nullptr )
+            return *rate;
+
+        // the asset was created after the table was built
+        return get_exchange_rate_by_symbol( &db, asset.symbol );
+    }
+
+    void exchange_rate_table_index::object_inserted( const object& obj )
+    {
+        _valid = false;
+    }
+
+    void exchange_rate_table_index::object_removed( const object& obj )
+    {
+        _valid = false;
+    }
+
+    void exchange_rate_table_index::about_to_modify( const object& before )
+    {
+        assert( dynamic_cast<const exchange_rate_object*>( &before ) ); // for debug only
+        _before_update_block_num = static_cast<const exchange_rate_object&>( before ).last_update_block_num;
+    }
+
+    void exchange_rate_table_index::object_modified( const object& after )
+    {
+        // a publication always moves last_update_block_num, so does the undo of one
+        if( static_cast<const exchange_rate_object&>( after ).last_update_block_num != _before_update_block_num )
+            _valid = false;
+    }
+
+    const double* exchange_rate_table_index::find( const graphene::chain::database& db, const asset_object& asset )const
+    {
+        if( !_valid )
+        {
+            const auto& rates = db.get_index_type<exchange_rate_index>( ).indices( ).get<by_id>( );
+            const auto& assets = db.get_index_type<asset_index>( ).indices( ).get<by_symbol>( );
+
+            _rates.clear( );
+            if( !rates.empty( ) )
+            {
+                _rates.reserve( rates.begin( )->last_exchange_rate.size( ) );
+                for( const auto& rate : rates.begin( )->last_exchange_rate )
+                {
+                    auto itr = assets.find( rate.first );
+                    if( itr != assets.end( ) )
+                        _rates[itr->id] = rate.second;
+                }
+            }
+            _valid = true;
+        }
+
+        auto itr = _rates.find( asset.id );
+        return itr == _rates.end( ) ? nullptr : &itr->second;
+    }
+}}
@@ -68,11 +68,31 @@ namespace graphene { namespace chain {
         };
 
 
+      /**
+       * Reasons for a karma change, stored instead of the text in every history entry
+       */
+      enum karma_change_reason
+      {
+          karma_account_created = 0,
+          karma_monthly_payment_settled,
+          karma_monthly_payment_delayed,
+          karma_credit_completed,
+          karma_credit_defaulted,
+          karma_credit_completed_forced
+      };
+
+      /// text shown to users for @p reason
+      std::string karma_change_reason_text( karma_change_reason reason );
+
+      /**
+       * A karma history entry as returned by the API
+       */
       struct karma_history_entry
       {
           time_point_sec date;
           float          amount;
           std::string    info;  
+          uint32_t       sequence = 0;
       };      
 
    /**
@@ -163,7 +183,8 @@ namespace graphene { namespace chain {
     * @ingroup object
     * @ingroup implementation
     *
-    * This object contains history of karma (rating)    
+    * This object contains history of karma (rating). The entries themselves are kept as
+    * @ref karma_history_entry_object so a karma change never copies the whole history.
     */
    class account_history_of_karma_object : public abstract_object<account_history_of_karma_object>
    {
@@ -172,21 +193,41 @@ namespace graphene { namespace chain {
          static const uint8_t type_id  = account_history_of_karma_object_type;
 
       account_id_type account;      
-      std::vector<karma_history_entry> karma_history;
       extensions_type            extensions;
+   };
 
-      std::vector<karma_history_entry> get_karma_history()const { return karma_history; }
-      void add_history_entry(time_point_sec date, float amount, std::string info) 
-      {
-            karma_history_entry entry; 
+   /**
+    * @class karma_history_entry_object
+    * @ingroup object
+    * @ingroup implementation
+    *
+    * One karma change of an account, @ref sequence counts the changes of that account from 0.
+    */
+   class karma_history_entry_object : public abstract_object<karma_history_entry_object>
+   {
+      public:
+         static const uint8_t space_id = implementation_ids;
+         static const uint8_t type_id  = impl_karma_history_entry_object_type;
+
+         account_id_type     account;
+         uint32_t            sequence = 0;
+         time_point_sec      date;
+         float               amount = 0;
+         karma_change_reason reason = karma_account_created;
+
+         karma_history_entry to_entry()const
+         {
+            karma_history_entry entry;
             entry.date = date;
             entry.amount = amount;
-            entry.info = info; 
-            karma_history.push_back(entry); 
-      }
+            entry.info = karma_change_reason_text( reason );
+            entry.sequence = sequence;
+            return entry;
+         }
    };
 
-      void update_account_karma(graphene::chain::database* db, account_id_type id, float amount, std::string info);
+      void add_karma_history_entry(graphene::chain::database& db, account_id_type id, float amount, karma_change_reason reason);
+      void update_account_karma(graphene::chain::database* db, account_id_type id, float amount, karma_change_reason reason);
 
    /**
     * @brief This class represents an account on the object graph
@@ -402,6 +443,61 @@ namespace graphene { namespace chain {
          map< account_id_type, set<account_id_type> > referred_by;
    };
 
+   /**
+    *  @brief Counts of accounts per karma value in a treap that keeps the total of every subtree, so the number
+    *  of accounts above a karma takes one walk from the root, logarithmic in the number of distinct values.
+    */
+   class karma_rank_tree
+   {
+      public:
+         void     add( float karma );
+         void     sub( float karma );
+
+         /** @return the number of accounts with a karma greater than @p karma */
+         uint32_t count_above( float karma )const;
+         uint32_t size()const;
+
+      private:
+         struct node
+         {
+            float             karma;
+            uint32_t          priority;
+            uint32_t          count;
+            uint32_t          total;
+            unique_ptr<node>  left;
+            unique_ptr<node>  right;
+         };
+
+         static uint32_t total( const unique_ptr<node>& n ) { return n ? n->total : 0; }
+         static void     update( node& n ) { n.total = n.count + total( n.left ) + total( n.right ); }
+         static void     rotate_left( unique_ptr<node>& n );
+         static void     rotate_right( unique_ptr<node>& n );
+         static void     adjust( unique_ptr<node>& n, float karma, bool increment );
+         static void     erase( unique_ptr<node>& n );
+
+         unique_ptr<node> _root;
+   };
+
+   /**
+    *  @brief This secondary index counts the accounts per karma value, so the rank of an account costs
+    *  a logarithmic number of steps instead of the number of accounts.
+    */
+   class account_karma_index : public secondary_index
+   {
+      public:
+         virtual void object_inserted( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void about_to_modify( const object& before ) override;
+         virtual void object_modified( const object& after  ) override;
+
+         /** @return the number of accounts with a karma greater than @p karma */
+         uint32_t count_above( float karma )const;
+
+      private:
+         karma_rank_tree  accounts_by_karma;
+         float            before_karma = 0;
+   };
+
    struct by_account_asset;
    struct by_asset_balance;
    /**
@@ -440,6 +536,7 @@ namespace graphene { namespace chain {
    typedef generic_index<account_balance_object, account_balance_object_multi_index_type> account_balance_index;
 
    struct by_name{};
+   struct by_karma{};
 
    /**
     * @ingroup object_index
@@ -448,7 +545,13 @@ namespace graphene { namespace chain {
       account_object,
       indexed_by<
          ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
-         ordered_unique< tag<by_name>, member<account_object, string, &account_object::name> >
+         ordered_unique< tag<by_name>, member<account_object, string, &account_object::name> >,
+         ordered_unique< tag<by_karma>,
+            composite_key< account_object,
+               member<account_object, float, &account_object::karma>,
+               member< object, object_id_type, &object::id >
+            >
+         >
       >
    > account_multi_index_type;
 
@@ -457,13 +560,16 @@ namespace graphene { namespace chain {
     */
    typedef generic_index<account_object, account_multi_index_type> account_index;
 
+   struct by_account;
+
    /**
     * @ingroup object_index
     */
    typedef multi_index_container<
       account_history_of_karma_object,
       indexed_by<
-         ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >
+         ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
+         ordered_unique< tag<by_account>, member< account_history_of_karma_object, account_id_type, &account_history_of_karma_object::account > >
       >
    > history_of_karma_multi_index_type;
 
@@ -471,6 +577,37 @@ namespace graphene { namespace chain {
     * @ingroup object_index
     */
    typedef generic_index<account_history_of_karma_object, history_of_karma_multi_index_type> account_history_of_karma_index;
+
+   struct by_account_seq;
+   struct by_account_date;
+
+   /**
+    * @ingroup object_index
+    */
+   typedef multi_index_container<
+      karma_history_entry_object,
+      indexed_by<
+         ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
+         ordered_unique< tag<by_account_seq>,
+            composite_key< karma_history_entry_object,
+               member< karma_history_entry_object, account_id_type, &karma_history_entry_object::account >,
+               member< karma_history_entry_object, uint32_t, &karma_history_entry_object::sequence >
+            >
+         >,
+         ordered_unique< tag<by_account_date>,
+            composite_key< karma_history_entry_object,
+               member< karma_history_entry_object, account_id_type, &karma_history_entry_object::account >,
+               member< karma_history_entry_object, time_point_sec, &karma_history_entry_object::date >,
+               member< karma_history_entry_object, uint32_t, &karma_history_entry_object::sequence >
+            >
+         >
+      >
+   > karma_history_entry_multi_index_type;
+
+   /**
+    * @ingroup object_index
+    */
+   typedef generic_index<karma_history_entry_object, karma_history_entry_multi_index_type> karma_history_entry_index;
 }}
 
 FC_REFLECT( graphene::chain::personal_info, (login)(email)(firstName)(lastName)(facebook)(mobile)(taxResidence) )
@@ -479,7 +616,11 @@ FC_REFLECT( graphene::chain::bank_account, (bankName)(bankSwift)(bankAccount)(ba
 
 FC_REFLECT( graphene::chain::additional_info, (about)(companyName)(companyActivity)(companyVat)(companyWebsite)(companyYoutube)(companyPdf) )
 
-FC_REFLECT( graphene::chain::karma_history_entry, (date)(amount)(info) )
+FC_REFLECT_ENUM( graphene::chain::karma_change_reason,
+                 (karma_account_created)(karma_monthly_payment_settled)(karma_monthly_payment_delayed)
+                 (karma_credit_completed)(karma_credit_defaulted)(karma_credit_completed_forced) )
+
+FC_REFLECT( graphene::chain::karma_history_entry, (date)(amount)(info)(sequence) )
 
 FC_REFLECT_DERIVED( graphene::chain::account_object,
                     (graphene::db::object),
@@ -511,5 +652,9 @@ FC_REFLECT_DERIVED( graphene::chain::account_statistics_object,
 
 FC_REFLECT_DERIVED( graphene::chain::account_history_of_karma_object,
                     (graphene::db::object),
-                    (account)(karma_history)(extensions) )
+                    (account)(extensions) )
+
+FC_REFLECT_DERIVED( graphene::chain::karma_history_entry_object,
+                    (graphene::db::object),
+                    (account)(sequence)(date)(amount)(reason) )
 
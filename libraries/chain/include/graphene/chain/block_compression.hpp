@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <cstddef>
+#include <vector>
+
+namespace graphene { namespace chain {
+
+   /**
+    * A small LZ77 codec for the chunks of the block log, so the compressed format needs no library beyond fc.
+    *
+    * The compressed form is a sequence of a varint literal count, the literals, a varint match length less four and
+    * a two byte little endian distance back into the output. The last sequence ends after its literals.
+    */
+   std::vector<char> compress_chunk( const char* data, size_t size );
+
+   /**
+    * Restores @p raw_size bytes compressed by @ref compress_chunk into @p out, throws on malformed input.
+    */
+   void decompress_chunk( const char* data, size_t size, char* out, size_t raw_size );
+
+} }
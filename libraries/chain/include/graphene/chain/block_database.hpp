@@ -28,15 +28,31 @@
 namespace graphene { namespace chain {
    class index_entry;
 
+   /**
+    * Blocks appended to one file, with an index file of fixed size entries by block number.
+    *
+    * Reads use positional I/O and share no stream state, so any number of threads can fetch blocks while the
+    * chain thread stores new ones. Storing and removing blocks is left to one thread.
+    *
+    * Blocks may also be kept in compressed chunks of consecutive blocks, written by @ref store_chunk. Their index
+    * entries point into the chunk, so they are fetched, removed and replaced like the others.
+    */
    class block_database 
    {
       public:
+         block_database() {}
+         block_database( const block_database& ) = delete;
+         block_database& operator = ( const block_database& ) = delete;
+         ~block_database();
+
          void open( const fc::path& dbdir );
          bool is_open()const;
          void flush();
          void close();
 
          void store( const block_id_type& id, const signed_block& b );
+         /// stores @p blocks, which have to follow each other, as one compressed chunk
+         void store_chunk( const vector<signed_block>& blocks );
          void remove( const block_id_type& id );
 
          bool                   contains( const block_id_type& id )const;
@@ -47,8 +63,26 @@ namespace graphene { namespace chain {
          optional<block_id_type> last_id()const;
       private:
          optional<index_entry> last_index_entry()const;
+         /// @return the index entry of @p block_num, an empty optional if the index does not reach it
+         optional<index_entry> read_index_entry( uint32_t block_num )const;
+         optional<signed_block> read_block( const index_entry& e )const;
+         /// @return the decompressed chunk @p chunk_num, cached per thread until another chunk is read
+         const vector<char>&    read_chunk( uint32_t chunk_num )const;
+         /// @return whether @p e points to a block with its id within the blocks file, reading only the block header
+         bool                   check_entry( const index_entry& e )const;
+
          fc::path _index_filename;
-         mutable std::fstream _blocks;
-         mutable std::fstream _block_num_to_pos;
+         int      _blocks = -1;
+         int      _block_num_to_pos = -1;
+         uint64_t _blocks_size = 0;
+
+         fc::path _chunks_filename;
+         fc::path _chunk_index_filename;
+         int      _chunks = -1;
+         int      _chunk_index = -1;
+         uint64_t _chunks_size = 0;
+         uint32_t _chunk_count = 0;
+         /// tells the chunks of this database apart from those of others in the per thread cache
+         uint64_t _chunk_cache_tag = 0;
    };
 } }
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <graphene/chain/protocol/block.hpp>
+#include <graphene/chain/signature_recovery.hpp>
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace graphene { namespace chain {
+   class block_database;
+
+   /**
+    * Reads the blocks of a range ahead of the thread applying them.
+    *
+    * Worker threads fetch and unpack runs of consecutive blocks from the block database, check their transaction
+    * merkle roots, precompute the transaction digests and, if asked to, recover the signature keys. They stay at most
+    * @ref window blocks ahead of the block taken last, @ref next hands the blocks out in order. The block database
+    * must not be written while the prefetcher exists.
+    */
+   class block_prefetcher
+   {
+      public:
+         struct prefetched_block
+         {
+            signed_block block;
+            /// the merkle root of the block was found to match its transactions
+            bool         merkle_checked = false;
+            /// the keys of every transaction, if the prefetcher recovers them
+            vector<recovered_signature_keys> signature_keys;
+         };
+
+         /// blocks a worker fetches at once, consecutive blocks usually share a compressed chunk
+         static const uint32_t run_size = 16;
+
+         block_prefetcher( const block_database& blocks, uint32_t first_block_num, uint32_t last_block_num,
+                           const chain_id_type& chain_id, bool recover_signatures = false,
+                           uint32_t thread_count = 0, uint32_t window = 512 );
+         block_prefetcher( const block_prefetcher& ) = delete;
+         block_prefetcher& operator = ( const block_prefetcher& ) = delete;
+         ~block_prefetcher();
+
+         /**
+          * Waits for the next block of the range. Rethrows the exception fetching it failed with.
+          * @return the block, an empty optional if the block database does not have it or the range is done
+          */
+         optional<prefetched_block> next();
+
+      private:
+         struct slot
+         {
+            bool                        ready = false;
+            optional<prefetched_block>  block;
+            std::exception_ptr          error;
+         };
+
+         void work();
+
+         const block_database&    _blocks;
+         const uint32_t           _last_block_num;
+         const uint32_t           _window;
+         const chain_id_type      _chain_id;
+         const bool               _recover_signatures;
+
+         std::mutex               _mutex;
+         std::condition_variable  _ready;
+         std::condition_variable  _taken;
+         vector<slot>             _slots;
+         uint32_t                 _next_to_fetch;
+         uint32_t                 _next_to_take;
+         bool                     _stopping = false;
+
+         vector<std::thread>      _threads;
+   };
+
+} }
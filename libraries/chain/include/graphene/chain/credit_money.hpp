@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/asset_object.hpp>
+
+namespace graphene { namespace chain {
+
+   /**
+    * An amount in satoshis of one asset together with the precision of the asset.
+    *
+    * The credit formulas work with real numbers of whole units. This type converts between them and the
+    * satoshi amounts with the compile time power of ten tables instead of pow( 10, precision ), so a
+    * conversion is one multiplication or division. The results are the ones the former conversions gave,
+    * real amounts are truncated towards zero as the assignment of a double to a share_type did.
+    */
+   class credit_money
+   {
+      public:
+         credit_money( share_type amount, asset_id_type asset_id, uint8_t precision )
+            : _amount( amount ), _asset_id( asset_id ), _scale( asset::real_scaled_precision( precision ) ) {}
+
+         credit_money( const asset& a, const asset_object& type )
+            : credit_money( a.amount, type.get_id( ), type.precision ) { FC_ASSERT( a.asset_id == type.get_id( ) ); }
+
+         /** @return @p real whole units of @p type, the fraction of a satoshi is dropped */
+         static credit_money from_real( const asset_object& type, double real )
+         {
+            credit_money result( 0, type.get_id( ), type.precision );
+            result._amount = int64_t( real * result._scale );
+            return result;
+         }
+
+         /** @return the amount in whole units, the same as @ref asset_object::amount_to_real for amounts not below zero */
+         double      to_real( )const   { return double( _amount.value ) / _scale; }
+
+         share_type  amount( )const    { return _amount; }
+         asset       to_asset( )const  { return asset( _amount, _asset_id ); }
+
+      private:
+         share_type     _amount;
+         asset_id_type  _asset_id;
+         double         _scale;
+   };
+
+} }
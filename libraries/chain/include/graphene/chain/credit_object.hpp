@@ -33,10 +33,8 @@
 #include <boost/date_time/gregorian/gregorian.hpp>
 #include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/json_parser.hpp>
-#include <boost/algorithm/string.hpp>
 
+#include <fc/array.hpp>
 #include <fc/reflect/reflect.hpp>
 #include <graphene/chain/protocol/config.hpp>
 #include <graphene/chain/protocol/types.hpp>
@@ -90,6 +88,95 @@ namespace graphene { namespace chain {
          fetch_all
    };
 
+   /**
+    * Events appended to the credit history. Only the facts are stored in the chain state, the human readable
+    * @ref credit_object::history and @ref credit_object::history_json are rendered from them on request.
+    */
+   struct credit_created_event
+   {
+      std::string     uuid;
+      account_id_type borrower;
+   };
+
+   struct credit_approved_event
+   {
+      std::string     uuid;
+      account_id_type creditor;
+      asset           loan;
+      uint32_t        loan_period = 0;
+      double          monthly_payment = 0;
+   };
+
+   struct monthly_payment_settled_event
+   {
+      asset           settled;
+      uint32_t        month_elapsed = 0;
+      asset           deposit_left;
+   };
+
+   struct monthly_payment_missed_event
+   {
+      asset           not_settled;
+   };
+
+   struct monthly_payment_settled_from_deposit_event
+   {
+      asset           from_borrower;
+      asset           from_deposit;
+      asset           transfered;
+      double          deposit_to_core = 0;
+      double          loan_to_core = 0;
+      uint32_t        month_elapsed = 0;
+      asset           deposit_left;
+   };
+
+   struct credit_completed_event
+   {
+      asset           deposit_returned;
+   };
+
+   struct credit_defaulted_event
+   {
+      asset           transfered;
+      asset           deposit_returned;
+   };
+
+   struct stop_loss_event
+   {
+      double          deposit_in_core = 0;
+      double          loan_threshold_in_core = 0;
+      asset           from_borrower;
+      asset           from_deposit;
+      asset           transfered;
+      asset           deposit_returned;
+   };
+
+   struct credit_completed_forced_event
+   {
+      asset           deposit_returned;
+   };
+
+   typedef static_variant<
+      credit_created_event,
+      credit_approved_event,
+      monthly_payment_settled_event,
+      monthly_payment_missed_event,
+      monthly_payment_settled_from_deposit_event,
+      credit_completed_event,
+      credit_defaulted_event,
+      stop_loss_event,
+      credit_completed_forced_event
+   > credit_history_event_data;
+
+   struct credit_history_event
+   {
+      time_point_sec            time;
+      credit_history_event_data data;
+   };
+
+   /// binary form of @ref credit_object::object_uuid used as the index key
+   typedef fc::array<char, 16> credit_uuid_type;
+
    class credit_object : public graphene::db::abstract_object<credit_object>
    {
       public:
@@ -97,6 +184,7 @@ namespace graphene { namespace chain {
          static const uint8_t type_id  = credit_object_type;
 
          std::string object_uuid; 
+         credit_uuid_type uuid_key;
          e_credit_object_status status;
 
          borrower_info borrower;
@@ -108,9 +196,25 @@ namespace graphene { namespace chain {
 
          uint32_t expired_time_start = 0; 
 
+         /// monthly payments transfered to the creditor so far, in the loan asset
+         share_type monthly_inflows;
+
+         /// earliest head block time at which @ref process may change this credit
+         time_point_sec next_process_time = time_point_sec::maximum();
+
          std::map<string,account_id_type> comments;
+         std::vector<credit_history_event> history_events;
+
+         /// rendered from @ref history_events by @ref render_history, empty in the chain state
          std::vector<string> history;
          std::string history_json;
+
+         template<typename Event>
+         void              add_history_event( time_point_sec time, Event&& e )
+         {
+            history_events.push_back( credit_history_event{ time, credit_history_event_data( std::forward<Event>( e ) ) } );
+         }
+         void              render_history( const graphene::chain::database& db );
          
          void              process( graphene::chain::database* db );
          void              on_next_month( graphene::chain::database* db );
@@ -122,10 +226,52 @@ namespace graphene { namespace chain {
          void              complete_credit_operation_ubnormal( graphene::chain::database* db );           
 
          double            calculate_monthly_payment( double loan_sum, double annual_loan_rate, uint32_t loan_period_in_moths );
+
+         /// read-only check whether @ref process would change more than @ref next_process_time at the head block
+         bool              needs_processing( const graphene::chain::database& db )const;
+         bool              deposit_covers_loan( const graphene::chain::database& db )const;
+         time_point_sec    next_payment_time( const graphene::chain::database& db )const;
+         /// when an overdue payment is settled from the deposit or defaults the credit
+         time_point_sec    overdue_deadline( const graphene::chain::database& db )const;
+         asset             monthly_payment_asset( const graphene::chain::database& db )const;
+         bool              borrower_can_pay( const graphene::chain::database& db )const;
+         /// the @ref next_process_time @ref schedule_next_process sets
+         time_point_sec    scheduled_process_time( const graphene::chain::database& db, bool recheck_deposit = false )const;
+         void              schedule_next_process( const graphene::chain::database& db, bool recheck_deposit = false );
+
+         account_id_type   borrower_id( )const { return borrower.borrower; }
+         account_id_type   creditor_id( )const { return creditor.creditor; }
+         asset_id_type     loan_asset_id( )const { return borrower.loan_asset.asset_id; }
+
+         /// a monthly payment of the credit is past due and not settled yet
+         bool              is_overdue( )const
+         {
+            return status == e_credit_object_status::in_progress && expired_time_start != 0;
+         }
+
+         /// whether the deposit has to cover the loan at the published exchange rates
+         bool              has_margin( )const
+         {
+            return status == e_credit_object_status::in_progress && !borrower.collateral_free && borrower.loan_asset.amount > 0;
+         }
+         /// deposit per loan in raw amounts, orders the credits of one asset pair by how far they are from their margin
+         price             collateralization( )const
+         {
+            if( !has_margin( ) )
+               return price{ asset( 0, borrower.deposit_asset.asset_id ), asset( 1, borrower.loan_asset.asset_id ) };
+            return price{ borrower.deposit_asset, borrower.loan_asset };
+         }
    };
 
    struct by_request_creation_time{};
    struct by_uuid{};
+   struct by_next_process_time{};
+   struct by_status{};
+   struct by_status_loan_asset{};
+   struct by_borrower{};
+   struct by_creditor{};
+   struct by_collateralization{};
+   struct by_overdue_borrower{};
 
    /**
     * @ingroup object_index
@@ -134,8 +280,68 @@ namespace graphene { namespace chain {
       credit_object,
       indexed_by<
          ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
-         ordered_non_unique< tag<by_request_creation_time>, member<credit_object, time_point_sec, &credit_object::request_creation_time> >,
-         ordered_non_unique< tag<by_uuid>, member<credit_object, string, &credit_object::object_uuid> >
+         ordered_unique< tag<by_request_creation_time>,
+            composite_key< credit_object,
+               member<credit_object, time_point_sec, &credit_object::request_creation_time>,
+               member< object, object_id_type, &object::id >
+            >
+         >,
+         ordered_unique< tag<by_uuid>,
+            composite_key< credit_object,
+               member<credit_object, credit_uuid_type, &credit_object::uuid_key>,
+               member< object, object_id_type, &object::id >
+            >
+         >,
+         ordered_unique< tag<by_next_process_time>,
+            composite_key< credit_object,
+               member<credit_object, time_point_sec, &credit_object::next_process_time>,
+               member< object, object_id_type, &object::id >
+            >
+         >,
+         ordered_unique< tag<by_status>,
+            composite_key< credit_object,
+               member<credit_object, e_credit_object_status, &credit_object::status>,
+               member< object, object_id_type, &object::id >
+            >
+         >,
+         ordered_unique< tag<by_status_loan_asset>,
+            composite_key< credit_object,
+               member<credit_object, e_credit_object_status, &credit_object::status>,
+               const_mem_fun<credit_object, asset_id_type, &credit_object::loan_asset_id>,
+               member<credit_object, time_point_sec, &credit_object::request_creation_time>,
+               member< object, object_id_type, &object::id >
+            >
+         >,
+         ordered_unique< tag<by_borrower>,
+            composite_key< credit_object,
+               const_mem_fun<credit_object, account_id_type, &credit_object::borrower_id>,
+               member<credit_object, time_point_sec, &credit_object::request_creation_time>,
+               member< object, object_id_type, &object::id >
+            >
+         >,
+         ordered_unique< tag<by_creditor>,
+            composite_key< credit_object,
+               const_mem_fun<credit_object, account_id_type, &credit_object::creditor_id>,
+               member<credit_object, time_point_sec, &credit_object::request_creation_time>,
+               member< object, object_id_type, &object::id >
+            >
+         >,
+         ordered_unique< tag<by_collateralization>,
+            composite_key< credit_object,
+               const_mem_fun<credit_object, bool, &credit_object::has_margin>,
+               const_mem_fun<credit_object, price, &credit_object::collateralization>,
+               member< object, object_id_type, &object::id >
+            >
+         >,
+         ordered_unique< tag<by_overdue_borrower>,
+            composite_key< credit_object,
+               const_mem_fun<credit_object, bool, &credit_object::is_overdue>,
+               const_mem_fun<credit_object, account_id_type, &credit_object::borrower_id>,
+               const_mem_fun<credit_object, asset_id_type, &credit_object::loan_asset_id>,
+               member<credit_object, time_point_sec, &credit_object::request_creation_time>,
+               member< object, object_id_type, &object::id >
+            >
+         >
       >
    > credit_multi_index_type;
 
@@ -143,6 +349,50 @@ namespace graphene { namespace chain {
     * @ingroup object_index
     */
    typedef generic_index<credit_object, credit_multi_index_type> credit_index;
+
+   /**
+    * Parses the canonical 8-4-4-4-12 text form of a credit uuid, returns an empty optional for anything else.
+    */
+   optional<credit_uuid_type> parse_credit_uuid( const std::string& uuid );
+
+   /**
+    * @return the credit whose @ref credit_object::object_uuid equals @p uuid, or nullptr if there is none
+    */
+   const credit_object* find_credit_by_uuid( const database& db, const std::string& uuid );
+
+   /**
+    *  @brief This secondary index of the global properties keeps the credit parameters resolved.
+    *
+    *  The options are copied out of the parameter extensions on the first lookup after the global properties
+    *  changed, including when an undo brings back older ones, so the credit code reads them without scanning the
+    *  extensions or copying the special account name. The special accounts are found by name once and then
+    *  only checked to still exist, an account created after the lookup failed is found on the next one.
+    */
+   class credit_parameters_index : public secondary_index
+   {
+      public:
+         virtual void object_inserted( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void object_modified( const object& after  ) override;
+
+         const chain_parameters::ext::credit_options&                 credit_options( const database& db )const;
+         const chain_parameters::ext::credit_referrer_bonus_options&  bonus_options( const database& db )const;
+
+         /** @return the account named by @ref chain_parameters::ext::credit_referrer_bonus_options::special_account_name, nullptr if there is none */
+         const account_object* special_account( const database& db )const;
+         /** @return the account named @ref SPECIAL_CONVERSION_ACCOUNT, nullptr if there is none */
+         const account_object* conversion_account( const database& db )const;
+
+      private:
+         void refresh( const database& db )const;
+         const account_object* find_account( const database& db, optional<account_id_type>& cached, const string& name )const;
+
+         mutable bool                                                 _valid = false;
+         mutable chain_parameters::ext::credit_options                _credit_options;
+         mutable chain_parameters::ext::credit_referrer_bonus_options _bonus_options;
+         mutable optional<account_id_type>                            _special_account;
+         mutable optional<account_id_type>                            _conversion_account;
+   };
 }}
 
 FC_REFLECT_ENUM( graphene::chain::e_credit_object_status, (empty)(wating_for_acceptance)(in_progress)(cancalled)(complete_normal)(complete_ubnormal)(fetch_all) )
@@ -150,9 +400,24 @@ FC_REFLECT_ENUM( graphene::chain::e_credit_object_status, (empty)(wating_for_acc
 FC_REFLECT( graphene::chain::borrower_info, (borrower)(loan_memo)(loan_asset)(loan_persent)(loan_period)(deposit_asset)(collateral_free) )
 FC_REFLECT( graphene::chain::creditor_info, (creditor)(credit_memo)(credit_asset)(monthly_payment) )
 
+FC_REFLECT( graphene::chain::credit_created_event, (uuid)(borrower) )
+FC_REFLECT( graphene::chain::credit_approved_event, (uuid)(creditor)(loan)(loan_period)(monthly_payment) )
+FC_REFLECT( graphene::chain::monthly_payment_settled_event, (settled)(month_elapsed)(deposit_left) )
+FC_REFLECT( graphene::chain::monthly_payment_missed_event, (not_settled) )
+FC_REFLECT( graphene::chain::monthly_payment_settled_from_deposit_event,
+            (from_borrower)(from_deposit)(transfered)(deposit_to_core)(loan_to_core)(month_elapsed)(deposit_left) )
+FC_REFLECT( graphene::chain::credit_completed_event, (deposit_returned) )
+FC_REFLECT( graphene::chain::credit_defaulted_event, (transfered)(deposit_returned) )
+FC_REFLECT( graphene::chain::stop_loss_event,
+            (deposit_in_core)(loan_threshold_in_core)(from_borrower)(from_deposit)(transfered)(deposit_returned) )
+FC_REFLECT( graphene::chain::credit_completed_forced_event, (deposit_returned) )
+FC_REFLECT_TYPENAME( graphene::chain::credit_history_event_data )
+FC_REFLECT( graphene::chain::credit_history_event, (time)(data) )
+
 FC_REFLECT_DERIVED( graphene::chain::credit_object,
                    ( graphene::db::object ),
                    ( object_uuid )
+                   ( uuid_key )
                    ( status )
                    ( borrower )
                    ( request_creation_time )
@@ -160,7 +425,10 @@ FC_REFLECT_DERIVED( graphene::chain::credit_object,
                    ( request_approvation_time )
                    ( settle_month_elapsed )
                    ( expired_time_start )
+                   ( monthly_inflows )
+                   ( next_process_time )
                    ( comments )
+                   ( history_events )
                    ( history )
                    ( history_json )
                   )
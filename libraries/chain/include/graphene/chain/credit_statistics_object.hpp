@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/protocol/operations.hpp>
+#include <graphene/chain/credit_object.hpp>
+#include <graphene/db/generic_index.hpp>
+#include <boost/multi_index/composite_key.hpp>
+
+namespace graphene { namespace chain {
+   class database;
+
+   /**
+    * The fields of a credit the statistics depend on. Taken instead of a copy of the credit before it is changed,
+    * so that the comments and the history are not copied.
+    */
+   struct credit_statistics_state
+   {
+      e_credit_object_status  status;
+      account_id_type         borrower;
+      account_id_type         creditor;
+      asset                   loan;
+      asset                   deposit;
+      share_type              monthly_inflows;
+
+      explicit credit_statistics_state( const credit_object& credit );
+   };
+
+   /**
+    * Totals of the credits in one asset. The loan fields count the credits lending the asset, the deposit
+    * field the credits pledging it.
+    */
+   struct credit_totals
+   {
+      share_type  outstanding_principal;  ///< loan amount of the credits in progress
+      share_type  locked_deposits;        ///< deposits of the requests and of the credits in progress
+      share_type  monthly_inflows;        ///< monthly payments transfered to the creditors so far
+      share_type  defaulted_principal;    ///< loan amount of the defaulted credits
+
+      uint32_t    requests_waiting = 0;
+      uint32_t    credits_in_progress = 0;
+      uint32_t    credits_settled = 0;
+      uint32_t    credits_defaulted = 0;
+
+      /** @return the part of @p credit in the totals of @p asset_id */
+      static credit_totals of( const credit_statistics_state& credit, asset_id_type asset_id );
+
+      bool operator == ( const credit_totals& o )const;
+      bool operator != ( const credit_totals& o )const { return !( *this == o ); }
+
+      credit_totals& operator += ( const credit_totals& o );
+      credit_totals& operator -= ( const credit_totals& o );
+   };
+
+   /**
+    * @class credit_statistics_object
+    * @ingroup implementation
+    *
+    * Totals of all credits in one asset, kept current by @ref update_credit_statistics.
+    */
+   class credit_statistics_object : public graphene::db::abstract_object<credit_statistics_object>
+   {
+      public:
+         static const uint8_t space_id = implementation_ids;
+         static const uint8_t type_id  = impl_credit_statistics_object_type;
+
+         asset_id_type  asset;
+         credit_totals  totals;
+   };
+
+   /**
+    * @class account_credit_statistics_object
+    * @ingroup implementation
+    *
+    * Totals of the credits of one account in one asset, kept current by @ref update_credit_statistics.
+    */
+   class account_credit_statistics_object : public graphene::db::abstract_object<account_credit_statistics_object>
+   {
+      public:
+         static const uint8_t space_id = implementation_ids;
+         static const uint8_t type_id  = impl_account_credit_statistics_object_type;
+
+         account_id_type  account;
+         asset_id_type    asset;
+         credit_totals    as_borrower;
+         credit_totals    as_creditor;
+   };
+
+   /**
+    * Moves the part of a credit in the statistics from its state @p before to its state @p after, nullptr stands
+    * for a credit that does not exist. Called wherever a credit is created, removed or changes its status, amounts
+    * or monthly inflows.
+    */
+   void update_credit_statistics( database& db, const credit_statistics_state* before, const credit_object* after );
+
+   struct by_asset;
+   struct by_account_asset;
+
+   /**
+    * @ingroup object_index
+    */
+   typedef multi_index_container<
+      credit_statistics_object,
+      indexed_by<
+         ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
+         ordered_unique< tag<by_asset>, member< credit_statistics_object, asset_id_type, &credit_statistics_object::asset > >
+      >
+   > credit_statistics_multi_index_type;
+
+   /**
+    * @ingroup object_index
+    */
+   typedef generic_index<credit_statistics_object, credit_statistics_multi_index_type> credit_statistics_index;
+
+   /**
+    * @ingroup object_index
+    */
+   typedef multi_index_container<
+      account_credit_statistics_object,
+      indexed_by<
+         ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
+         ordered_unique< tag<by_account_asset>,
+            composite_key< account_credit_statistics_object,
+               member< account_credit_statistics_object, account_id_type, &account_credit_statistics_object::account >,
+               member< account_credit_statistics_object, asset_id_type, &account_credit_statistics_object::asset >
+            >
+         >
+      >
+   > account_credit_statistics_multi_index_type;
+
+   /**
+    * @ingroup object_index
+    */
+   typedef generic_index<account_credit_statistics_object, account_credit_statistics_multi_index_type> account_credit_statistics_index;
+
+}}
+
+FC_REFLECT( graphene::chain::credit_totals,
+            (outstanding_principal)(locked_deposits)(monthly_inflows)(defaulted_principal)
+            (requests_waiting)(credits_in_progress)(credits_settled)(credits_defaulted) )
+
+FC_REFLECT_DERIVED( graphene::chain::credit_statistics_object, (graphene::db::object),
+                    (asset)(totals) )
+
+FC_REFLECT_DERIVED( graphene::chain::account_credit_statistics_object, (graphene::db::object),
+                    (account)(asset)(as_borrower)(as_creditor) )
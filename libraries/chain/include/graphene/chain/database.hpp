@@ -29,6 +29,7 @@
 #include <graphene/chain/fork_database.hpp>
 #include <graphene/chain/block_database.hpp>
 #include <graphene/chain/genesis_state.hpp>
+#include <graphene/chain/signature_recovery.hpp>
 #include <graphene/chain/evaluator.hpp>
 
 #include <graphene/db/object_database.hpp>
@@ -47,6 +48,7 @@ namespace graphene { namespace chain {
    using graphene::db::object;
    class op_evaluator;
    class transaction_evaluation_state;
+   class credit_parameters_index;
 
    struct budget_record;
 
@@ -90,11 +92,16 @@ namespace graphene { namespace chain {
           * @param data_dir Path to open or create database in
           * @param genesis_loader A callable object which returns the genesis state to initialize new databases on
           * @param db_version a version string that changes when the internal database format and/or logic is modified
+          * @param snapshot a snapshot written by @ref save_snapshot to start from instead of the stored objects or the
+          * genesis state, the blocks after it in the block database are replayed. Ignored when the stored objects are
+          * kept and the block database holds the head block of the snapshot, refused when the block database holds
+          * other blocks only
           */
           void open(
              const fc::path& data_dir,
              std::function<genesis_state_type()> genesis_loader,
-             const std::string& db_version );
+             const std::string& db_version,
+             const fc::path& snapshot = fc::path() );
 
          /**
           * @brief Rebuild object graph from block history and open detabase
@@ -104,6 +111,35 @@ namespace graphene { namespace chain {
           */
          void reindex(fc::path data_dir);
 
+         /**
+          * Writes all objects, the head block and the chain id to a checksummed file that @ref open can start from,
+          * see @ref pack_snapshot and @ref write_snapshot.
+          *
+          * Refuses a head block that is still reversible, unless it was replayed without undo history.
+          */
+         void save_snapshot( const fc::path& file )const;
+
+         /**
+          * @return the content of a snapshot of the head block, packed in memory so that it can be kept until the
+          * block is irreversible and written by @ref write_snapshot on another thread
+          */
+         vector<char> pack_snapshot()const;
+
+         /**
+          * Writes the content of a snapshot to a temporary file which is renamed when complete, so a failed or
+          * interrupted write never leaves a truncated snapshot behind. Does not touch the database.
+          */
+         static void write_snapshot( const fc::path& file, const vector<char>& content );
+
+         /**
+          * Makes replays check the signatures of the witnesses and transactions, which they skip otherwise. The
+          * signature keys are recovered on the threads reading the blocks ahead.
+          */
+         void set_replay_check_signatures( bool check ) { _replay_check_signatures = check; }
+
+         /// the keys recovered from transaction signatures, shared by pushed transactions and applied blocks
+         const signature_key_cache& get_signature_key_cache()const { return _signature_key_cache; }
+
          /**
           * @brief wipe Delete database from disk, and potentially the raw chain as well.
           * @param include_blocks If true, delete the raw chain as well as the database.
@@ -265,10 +301,21 @@ namespace graphene { namespace chain {
 
          decltype( chain_parameters::block_interval ) block_interval( )const;
 
+         /// The credit parameters of the global properties, resolved once per change of them
+         const chain_parameters::ext::credit_options&                 get_credit_options()const;
+         const chain_parameters::ext::credit_referrer_bonus_options&  get_bonus_options()const;
+         /// The account receiving the credit bonus, nullptr if it does not exist
+         const account_object*                                        find_special_account()const;
+         /// The account taking the deposits converted to the loan asset, nullptr if it does not exist
+         const account_object*                                        find_conversion_account()const;
+
          node_property_object& node_properties();
 
 
          uint32_t last_non_undoable_block_num() const;
+
+         /// Number of credit objects copied into the undo history while applying the last block
+         uint32_t last_block_credit_undo_clones()const { return _last_block_credit_undo_clones; }
          //////////////////// db_init.cpp ////////////////////
 
          void initialize_evaluators();
@@ -420,16 +467,30 @@ namespace graphene { namespace chain {
          template<class Index>
          vector<std::reference_wrapper<const typename Index::object_type>> sort_votable_objects(size_t count)const;
 
+         //////////////////// db_management.cpp ////////////////////
+         void load_snapshot( const fc::path& snapshot, const chain_id_type& chain_id );
+
          //////////////////// db_block.cpp ////////////////////
 
        public:
          // these were formerly private, but they have a fairly well-defined API, so let's make them public
-         void                  apply_block( const signed_block& next_block, uint32_t skip = skip_nothing );
+         /**
+          * @param signature_keys the keys of the transactions of @p next_block, recovered ahead from that very block,
+          *        nullptr to recover them here
+          * @param fresh_digests the transactions of @p next_block carry digests computed from their current content,
+          *        as the block prefetcher leaves them, instead of digests that may predate an assignment to a field
+          */
+         void                  apply_block( const signed_block& next_block, uint32_t skip = skip_nothing,
+                                            const vector<recovered_signature_keys>* signature_keys = nullptr,
+                                            bool fresh_digests = false );
          processed_transaction apply_transaction( const signed_transaction& trx, uint32_t skip = skip_nothing );
          operation_result      apply_operation( transaction_evaluation_state& eval_state, const operation& op );
       private:
-         void                  _apply_block( const signed_block& next_block );
-         processed_transaction _apply_transaction( const signed_transaction& trx );
+         void                  _apply_block( const signed_block& next_block,
+                                             const vector<recovered_signature_keys>* prefetched_keys, bool fresh_digests );
+         processed_transaction _apply_transaction( const signed_transaction& trx,
+                                                   const recovered_signature_keys* signature_keys = nullptr,
+                                                   bool fresh_digests = false );
          void                  _cancel_bids_and_revive_mpa( const asset_object& bitasset, const asset_bitasset_data_object& bad );
 
          ///Steps involved in applying a new block
@@ -507,6 +568,16 @@ namespace graphene { namespace chain {
          flat_map<uint32_t,block_id_type>  _checkpoints;
 
          node_property_object              _node_property_object;
+
+         uint32_t                          _last_block_credit_undo_clones = 0;
+         /// balances raised while process_credit_stories settles a credit, nullptr outside of it
+         flat_set<std::pair<account_id_type,asset_id_type>>* _credit_pass_funded = nullptr;
+
+         const credit_parameters_index*    _credit_parameters = nullptr;
+
+         bool                              _replay_check_signatures = false;
+         signature_recovery_pool           _signature_recovery;
+         signature_key_cache               _signature_key_cache;
    };
 
    namespace detail
@@ -49,11 +49,28 @@ namespace graphene { namespace chain {
         static const uint8_t space_id = protocol_ids;
         static const uint8_t type_id  = exchange_rate_object_type;
 
-        std::map< std::string, std::map< account_id_type, double >> current_exchange_rate;
-        std::map< std::string, std::pair<uint32_t, uint32_t>> current_exchange_rate_interval;// "asset": <first_set_exchange_rate_time, last_view_witnesses>
         std::map< std::string, double> last_exchange_rate; 
+        uint32_t last_update_block_num = 0; ///< block in which a new median was last published
+   };
+
+   /**
+    * Witness votes for the exchange rate of one asset. The object lives from the first vote until the median
+    * of the votes is published or the votes expire, see @ref database::process_exchange_rates.
+    */
+   class exchange_rate_votes_object : public graphene::db::abstract_object<exchange_rate_votes_object>
+   {
+      public:
+        static const uint8_t space_id = implementation_ids;
+        static const uint8_t type_id  = impl_exchange_rate_votes_object_type;
 
-        void   process(graphene::chain::database* db);
+        std::string                         symbol;
+        std::map< account_id_type, double > votes;           ///< rate by witness account
+        std::vector<double>                 sorted_votes;    ///< the rates of @ref votes in ascending order
+        uint32_t                            first_vote_time = 0;
+        uint32_t                            last_check_time = 0;
+
+        void   set_vote( account_id_type witness, double rate );
+        double median()const;
    };
 
    /**
@@ -71,14 +88,71 @@ namespace graphene { namespace chain {
     */
    typedef generic_index<exchange_rate_object, exchange_rate_multi_index_type> exchange_rate_index;
 
-   double get_exchange_rate_by_symbol( graphene::chain::database* db, std::string symbol );
+   struct by_symbol;
+   struct by_last_check_time;
+
+   /**
+    * @ingroup object_index
+    */
+   typedef multi_index_container<
+      exchange_rate_votes_object,
+      indexed_by<
+         ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
+         ordered_unique< tag<by_symbol>, member< exchange_rate_votes_object, std::string, &exchange_rate_votes_object::symbol > >,
+         ordered_unique< tag<by_last_check_time>,
+            composite_key< exchange_rate_votes_object,
+               member< exchange_rate_votes_object, uint32_t, &exchange_rate_votes_object::last_check_time >,
+               member< object, object_id_type, &object::id >
+            >
+         >
+      >
+   > exchange_rate_votes_multi_index_type;
+
+   /**
+    * @ingroup object_index
+    */
+   typedef generic_index<exchange_rate_votes_object, exchange_rate_votes_multi_index_type> exchange_rate_votes_index;
+
+   /**
+    *  @brief This secondary index keeps the published exchange rates keyed by asset id.
+    *
+    *  The table is rebuilt on the first lookup after a new median was published, including when an undo
+    *  brings back older rates, so all credit checks between two publications share one lookup structure.
+    */
+   class exchange_rate_table_index : public secondary_index
+   {
+      public:
+         virtual void object_inserted( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void about_to_modify( const object& before ) override;
+         virtual void object_modified( const object& after  ) override;
+
+         /** @return the published rate of @p asset in core asset, nullptr if there is none */
+         const double* find( const graphene::chain::database& db, const asset_object& asset )const;
+
+      private:
+         uint32_t                                     _before_update_block_num = 0;
+         mutable bool                                 _valid = false;
+         mutable flat_map<asset_id_type, double>      _rates;
+   };
+
+   double get_exchange_rate_by_symbol( const graphene::chain::database* db, const std::string& symbol );
+   double get_exchange_rate( const graphene::chain::database& db, const asset_object& asset );
 }}
 
 
 
 FC_REFLECT_DERIVED( graphene::chain::exchange_rate_object,
                    ( graphene::db::object ),
-                   ( current_exchange_rate )
-                   ( current_exchange_rate_interval)
                    ( last_exchange_rate )
+                   ( last_update_block_num )
+                  )
+
+FC_REFLECT_DERIVED( graphene::chain::exchange_rate_votes_object,
+                   ( graphene::db::object ),
+                   ( symbol )
+                   ( votes )
+                   ( sorted_votes )
+                   ( first_vote_time )
+                   ( last_check_time )
                   )
@@ -29,6 +29,22 @@ namespace graphene { namespace chain {
 
    extern const int64_t scaled_precision_lut[];
 
+   /** 10^exp as a double, exact for every exponent below 23 */
+   constexpr double real_pow10( unsigned exp )
+   {
+      return exp == 0 ? 1.0 : 10.0 * real_pow10( exp - 1 );
+   }
+
+   /** scaled_precision_lut as doubles, filled at compile time */
+   constexpr double real_scaled_precision_lut[19] =
+   {
+      real_pow10(  0 ), real_pow10(  1 ), real_pow10(  2 ), real_pow10(  3 ),
+      real_pow10(  4 ), real_pow10(  5 ), real_pow10(  6 ), real_pow10(  7 ),
+      real_pow10(  8 ), real_pow10(  9 ), real_pow10( 10 ), real_pow10( 11 ),
+      real_pow10( 12 ), real_pow10( 13 ), real_pow10( 14 ), real_pow10( 15 ),
+      real_pow10( 16 ), real_pow10( 17 ), real_pow10( 18 )
+   };
+
    struct asset
    {
       asset( share_type a = 0, asset_id_type id = asset_id_type() )
@@ -94,6 +110,13 @@ namespace graphene { namespace chain {
          FC_ASSERT( precision < 19 );
          return scaled_precision_lut[ precision ];
       }
+
+      /** the same value as pow( 10, precision ) without depending on the math library */
+      static double real_scaled_precision( uint8_t precision )
+      {
+         FC_ASSERT( precision < 19 );
+         return real_scaled_precision_lut[ precision ];
+      }
    };
 
    /**
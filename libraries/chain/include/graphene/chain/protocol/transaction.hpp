@@ -28,6 +28,7 @@
 #include <numeric>
 
 namespace graphene { namespace chain {
+   class signature_key_cache;
 
    /**
     * @defgroup transactions Transactions
@@ -91,6 +92,17 @@ namespace graphene { namespace chain {
       /// Calculate the digest used for signature validation
       digest_type         sig_digest( const chain_id_type& chain_id )const;
 
+      /**
+       * Packs the transaction once and keeps its digest and its signature digest with @p chain_id, which
+       * @ref digest, @ref id and @ref sig_digest return from then on. Copies keep them.
+       *
+       * Only for transactions which do not change any more: set_expiration, set_reference_block, clear and visiting
+       * the operations drop the digests, assigning to the fields does not.
+       */
+      void                precompute_digests( const chain_id_type& chain_id )const;
+      /// drops the digests of @ref precompute_digests, for transactions that may have been changed since
+      void                reset_digests()const { _digests.reset(); }
+
       void set_expiration( fc::time_point_sec expiration_time );
       void set_reference_block( const block_id_type& reference_block );
 
@@ -98,6 +110,7 @@ namespace graphene { namespace chain {
       template<typename Visitor>
       vector<typename Visitor::result_type> visit( Visitor&& visitor )
       {
+         _digests.reset();
          vector<typename Visitor::result_type> results;
          for( auto& op : operations )
             results.push_back(op.visit( std::forward<Visitor>( visitor ) ));
@@ -113,6 +126,16 @@ namespace graphene { namespace chain {
       }
 
       void get_required_authorities( flat_set<account_id_type>& active, flat_set<account_id_type>& owner, vector<authority>& other )const;
+
+   protected:
+      struct precomputed_digests
+      {
+         digest_type    digest;
+         chain_id_type  chain_id;
+         digest_type    sig_digest;
+      };
+
+      mutable optional<precomputed_digests> _digests;
    };
 
    /**
@@ -165,12 +188,13 @@ namespace graphene { namespace chain {
          uint32_t max_recursion = GRAPHENE_MAX_SIG_CHECK_DEPTH
          ) const;
 
-      flat_set<public_key_type> get_signature_keys( const chain_id_type& chain_id )const;
+      /// @param cache keeps the keys recovered before, the keys are recovered every time without it
+      flat_set<public_key_type> get_signature_keys( const chain_id_type& chain_id, signature_key_cache* cache = nullptr )const;
 
       vector<signature_type> signatures;
 
       /// Removes all operations and signatures
-      void clear() { operations.clear(); signatures.clear(); }
+      void clear() { operations.clear(); signatures.clear(); _digests.reset(); }
    };
 
    void verify_authority( const vector<operation>& ops, const flat_set<public_key_type>& sigs,
@@ -159,7 +159,11 @@ namespace graphene { namespace chain {
       impl_special_authority_object_type,
       impl_buyback_object_type,
       impl_fba_accumulator_object_type,
-      impl_collateral_bid_object_type
+      impl_collateral_bid_object_type,
+      impl_karma_history_entry_object_type,
+      impl_exchange_rate_votes_object_type,
+      impl_credit_statistics_object_type,
+      impl_account_credit_statistics_object_type
    };
 
    //typedef fc::unsigned_int            object_id_type;
@@ -218,6 +222,10 @@ namespace graphene { namespace chain {
    class buyback_object;
    class fba_accumulator_object;
    class collateral_bid_object;
+   class karma_history_entry_object;
+   class exchange_rate_votes_object;
+   class credit_statistics_object;
+   class account_credit_statistics_object;
 
    typedef object_id< implementation_ids, impl_global_property_object_type,  global_property_object>                    global_property_id_type;
    typedef object_id< implementation_ids, impl_dynamic_global_property_object_type,  dynamic_global_property_object>    dynamic_global_property_id_type;
@@ -239,6 +247,10 @@ namespace graphene { namespace chain {
    typedef object_id< implementation_ids, impl_buyback_object_type, buyback_object >                                    buyback_id_type;
    typedef object_id< implementation_ids, impl_fba_accumulator_object_type, fba_accumulator_object >                    fba_accumulator_id_type;
    typedef object_id< implementation_ids, impl_collateral_bid_object_type, collateral_bid_object >                      collateral_bid_id_type;
+   typedef object_id< implementation_ids, impl_karma_history_entry_object_type, karma_history_entry_object >            karma_history_entry_id_type;
+   typedef object_id< implementation_ids, impl_exchange_rate_votes_object_type, exchange_rate_votes_object >            exchange_rate_votes_id_type;
+   typedef object_id< implementation_ids, impl_credit_statistics_object_type, credit_statistics_object >                credit_statistics_id_type;
+   typedef object_id< implementation_ids, impl_account_credit_statistics_object_type, account_credit_statistics_object > account_credit_statistics_id_type;
 
    typedef fc::array<char, GRAPHENE_MAX_ASSET_SYMBOL_LENGTH>    symbol_type;
    typedef fc::ripemd160                                        block_id_type;
@@ -375,6 +387,10 @@ FC_REFLECT_ENUM( graphene::chain::impl_object_type,
                  (impl_buyback_object_type)
                  (impl_fba_accumulator_object_type)
                  (impl_collateral_bid_object_type)
+                 (impl_karma_history_entry_object_type)
+                 (impl_exchange_rate_votes_object_type)
+                 (impl_credit_statistics_object_type)
+                 (impl_account_credit_statistics_object_type)
                )
 
 FC_REFLECT_TYPENAME( graphene::chain::share_type )
@@ -407,6 +423,10 @@ FC_REFLECT_TYPENAME( graphene::chain::special_authority_id_type )
 FC_REFLECT_TYPENAME( graphene::chain::buyback_id_type )
 FC_REFLECT_TYPENAME( graphene::chain::fba_accumulator_id_type )
 FC_REFLECT_TYPENAME( graphene::chain::collateral_bid_id_type )
+FC_REFLECT_TYPENAME( graphene::chain::karma_history_entry_id_type )
+FC_REFLECT_TYPENAME( graphene::chain::exchange_rate_votes_id_type )
+FC_REFLECT_TYPENAME( graphene::chain::credit_statistics_id_type )
+FC_REFLECT_TYPENAME( graphene::chain::account_credit_statistics_id_type )
 FC_REFLECT_TYPENAME( graphene::chain::credit_id_type )
 FC_REFLECT_TYPENAME( graphene::chain::exchange_rate_id_type )
 
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <graphene/chain/protocol/transaction.hpp>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/identity.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace graphene { namespace chain {
+
+   /**
+    * The keys recovered from signatures of transaction digests, the least recently used dropped once there are
+    * more than the capacity. A transaction pushed to the node has its signatures recovered when it is pushed, when
+    * it is applied again after each block and when the block including it arrives, the cache spares all but the first.
+    *
+    * Any thread may recover keys, the keys are recovered outside the lock.
+    */
+   class signature_key_cache
+   {
+      public:
+         explicit signature_key_cache( size_t capacity = 1 << 15 );
+
+         /// @return the key @p signature of @p digest was made with, recovered only if it is not cached
+         public_key_type recover( const digest_type& digest, const signature_type& signature );
+
+         uint64_t hits()const;
+         uint64_t misses()const;
+         size_t   size()const;
+
+      private:
+         struct entry
+         {
+            digest_type      digest;
+            signature_type   signature;
+            public_key_type  key;
+         };
+         struct entry_hash
+         {
+            size_t operator()( const entry& e )const;
+         };
+         struct entry_equal
+         {
+            bool operator()( const entry& a, const entry& b )const
+            {
+               return a.digest == b.digest && a.signature == b.signature;
+            }
+         };
+         typedef boost::multi_index_container<
+            entry,
+            boost::multi_index::indexed_by<
+               boost::multi_index::sequenced<>,
+               boost::multi_index::hashed_unique< boost::multi_index::identity<entry>, entry_hash, entry_equal >
+            >
+         > entry_index;
+
+         const size_t        _capacity;
+         mutable std::mutex  _mutex;
+         entry_index         _entries;
+         uint64_t            _hits = 0;
+         uint64_t            _misses = 0;
+   };
+
+   /**
+    * The keys recovered from the signatures of one transaction, or the exception recovering them failed with,
+    * which is rethrown where the keys are checked.
+    */
+   struct recovered_signature_keys
+   {
+      flat_set<public_key_type>  keys;
+      std::exception_ptr         error;
+
+      static recovered_signature_keys of( const signed_transaction& trx, const chain_id_type& chain_id,
+                                          signature_key_cache* cache = nullptr );
+
+      /// @return the keys, rethrows the exception of a failed recovery
+      const flat_set<public_key_type>& get()const;
+   };
+
+   /**
+    * Threads recovering the signature keys of the transactions of a block before they are applied one after
+    * another. Recovery reads no chain state, so it runs on all transactions at once.
+    *
+    * The threads are started by the first block with more than one transaction. Blocks are recovered by one
+    * caller at a time, which works along with the threads.
+    */
+   class signature_recovery_pool
+   {
+      public:
+         explicit signature_recovery_pool( uint32_t thread_count = 0 );
+         signature_recovery_pool( const signature_recovery_pool& ) = delete;
+         signature_recovery_pool& operator = ( const signature_recovery_pool& ) = delete;
+         ~signature_recovery_pool();
+
+         /// @return the keys of every transaction of @p trxs, in the same order
+         vector<recovered_signature_keys> recover( const vector<processed_transaction>& trxs, const chain_id_type& chain_id,
+                                                   signature_key_cache* cache = nullptr );
+
+      private:
+         void work();
+         void run_job();
+
+         const uint32_t                      _thread_count;
+         vector<std::thread>                 _threads;
+
+         std::mutex                          _mutex;
+         std::condition_variable             _job_posted;
+         std::condition_variable             _job_done;
+         uint64_t                            _job_number = 0;
+         uint32_t                            _busy = 0;
+         bool                                _stopping = false;
+
+         const vector<processed_transaction>* _trxs = nullptr;
+         const chain_id_type*                _chain_id = nullptr;
+         signature_key_cache*                _cache = nullptr;
+         vector<recovered_signature_keys>*   _results = nullptr;
+         std::atomic<size_t>                 _next_trx;
+   };
+
+} }
@@ -23,6 +23,7 @@
  */
 #include <graphene/chain/exceptions.hpp>
 #include <graphene/chain/protocol/fee_schedule.hpp>
+#include <graphene/chain/signature_recovery.hpp>
 #include <fc/io/raw.hpp>
 #include <fc/bitutil.hpp>
 #include <fc/smart_ref_impl.hpp>
@@ -39,6 +40,8 @@ digest_type processed_transaction::merkle_digest()const
 
 digest_type transaction::digest()const
 {
+   if( _digests.valid() )
+      return _digests->digest;
    digest_type::encoder enc;
    fc::raw::pack( enc, *this );
    return enc.result();
@@ -46,12 +49,31 @@ digest_type transaction::digest()const
 
 digest_type transaction::sig_digest( const chain_id_type& chain_id )const
 {
+   if( _digests.valid() && _digests->chain_id == chain_id )
+      return _digests->sig_digest;
    digest_type::encoder enc;
    fc::raw::pack( enc, chain_id );
    fc::raw::pack( enc, *this );
    return enc.result();
 }
 
+void transaction::precompute_digests( const chain_id_type& chain_id )const
+{
+   if( _digests.valid() && _digests->chain_id == chain_id )
+      return;
+
+   // both digests hash the packed transaction, the signature digest after the chain id
+   auto packed = fc::raw::pack( *this );
+   precomputed_digests digests;
+   digests.digest = digest_type::hash( packed.data(), packed.size() );
+   digests.chain_id = chain_id;
+   digest_type::encoder enc;
+   fc::raw::pack( enc, chain_id );
+   enc.write( packed.data(), packed.size() );
+   digests.sig_digest = enc.result();
+   _digests = digests;
+}
+
 void transaction::validate() const
 {
    FC_ASSERT( operations.size() > 0, "A transaction must have at least one operation", ("trx",*this) );
@@ -85,10 +107,12 @@ signature_type graphene::chain::signed_transaction::sign(const private_key_type&
 void transaction::set_expiration( fc::time_point_sec expiration_time )
 {
     expiration = expiration_time;
+    _digests.reset();
 }
 
 void transaction::set_reference_block( const block_id_type& reference_block )
 {
+   _digests.reset();
    ref_block_num = fc::endian_reverse_u32(reference_block._hash[0]);
    ref_block_prefix = reference_block._hash[1];
 }
@@ -297,14 +321,14 @@ void verify_authority( const vector<operation>& ops, const flat_set<public_key_t
 } FC_CAPTURE_AND_RETHROW( (ops)(sigs) ) }
 
 
-flat_set<public_key_type> signed_transaction::get_signature_keys( const chain_id_type& chain_id )const
+flat_set<public_key_type> signed_transaction::get_signature_keys( const chain_id_type& chain_id, signature_key_cache* cache )const
 { try {
    auto d = sig_digest( chain_id );
    flat_set<public_key_type> result;
    for( const auto&  sig : signatures )
    {
       GRAPHENE_ASSERT(
-         result.insert( fc::ecc::public_key(sig,d) ).second,
+         result.insert( cache ? cache->recover( d, sig ) : public_key_type( fc::ecc::public_key(sig,d) ) ).second,
          tx_duplicate_sig,
          "Duplicate Signature detected" );
    }
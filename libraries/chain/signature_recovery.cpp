@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/chain/signature_recovery.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace graphene { namespace chain {
+
+signature_key_cache::signature_key_cache( size_t capacity )
+   : _capacity( std::max<size_t>( capacity, 1 ) )
+{
+}
+
+size_t signature_key_cache::entry_hash::operator()( const entry& e )const
+{
+   // both are as good as random, a word of each will do
+   uint64_t s;
+   memcpy( &s, e.signature.data + 1, sizeof(s) );
+   return size_t( e.digest._hash[0] ^ s );
+}
+
+public_key_type signature_key_cache::recover( const digest_type& digest, const signature_type& signature )
+{
+   entry e;
+   e.digest = digest;
+   e.signature = signature;
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      auto& by_key = _entries.get<1>();
+      auto itr = by_key.find( e );
+      if( itr != by_key.end() )
+      {
+         ++_hits;
+         _entries.relocate( _entries.begin(), _entries.project<0>( itr ) );
+         return itr->key;
+      }
+      ++_misses;
+   }
+
+   e.key = fc::ecc::public_key( signature, digest );
+
+   std::lock_guard<std::mutex> lock( _mutex );
+   _entries.push_front( e );
+   while( _entries.size() > _capacity )
+      _entries.pop_back();
+   return e.key;
+}
+
+uint64_t signature_key_cache::hits()const
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   return _hits;
+}
+
+uint64_t signature_key_cache::misses()const
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   return _misses;
+}
+
+size_t signature_key_cache::size()const
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   return _entries.size();
+}
+
+recovered_signature_keys recovered_signature_keys::of( const signed_transaction& trx, const chain_id_type& chain_id,
+                                                       signature_key_cache* cache )
+{
+   recovered_signature_keys result;
+   try {
+      trx.precompute_digests( chain_id );
+      result.keys = trx.get_signature_keys( chain_id, cache );
+   } catch( ... ) {
+      result.error = std::current_exception();
+   }
+   return result;
+}
+
+const flat_set<public_key_type>& recovered_signature_keys::get()const
+{
+   if( error )
+      std::rethrow_exception( error );
+   return keys;
+}
+
+signature_recovery_pool::signature_recovery_pool( uint32_t thread_count )
+   : _thread_count( thread_count ? thread_count : std::max( 2u, std::thread::hardware_concurrency() ) - 1 ),
+     _next_trx( 0 )
+{
+}
+
+signature_recovery_pool::~signature_recovery_pool()
+{
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      _stopping = true;
+   }
+   _job_posted.notify_all();
+   for( auto& thread : _threads )
+      thread.join();
+}
+
+vector<recovered_signature_keys> signature_recovery_pool::recover( const vector<processed_transaction>& trxs,
+                                                                   const chain_id_type& chain_id,
+                                                                   signature_key_cache* cache )
+{
+   vector<recovered_signature_keys> results( trxs.size() );
+   if( trxs.size() < 2 )
+   {
+      for( size_t i = 0; i < trxs.size(); ++i )
+         results[i] = recovered_signature_keys::of( trxs[i], chain_id, cache );
+      return results;
+   }
+
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      while( _threads.size() < _thread_count )
+         _threads.emplace_back( [this]() { work(); } );
+      _trxs = &trxs;
+      _chain_id = &chain_id;
+      _cache = cache;
+      _results = &results;
+      _next_trx = 0;
+      ++_job_number;
+   }
+   _job_posted.notify_all();
+
+   run_job();
+
+   // the job is withdrawn once the threads which joined it are done, threads waking up later find none
+   std::unique_lock<std::mutex> lock( _mutex );
+   _job_done.wait( lock, [this]() { return _busy == 0; } );
+   _trxs = nullptr;
+   _chain_id = nullptr;
+   _cache = nullptr;
+   _results = nullptr;
+   return results;
+}
+
+void signature_recovery_pool::run_job()
+{
+   for( size_t i = _next_trx++; i < _trxs->size(); i = _next_trx++ )
+      (*_results)[i] = recovered_signature_keys::of( (*_trxs)[i], *_chain_id, _cache );
+}
+
+void signature_recovery_pool::work()
+{
+   uint64_t last_job = 0;
+   std::unique_lock<std::mutex> lock( _mutex );
+   while( true )
+   {
+      _job_posted.wait( lock, [&]() { return _stopping || _job_number != last_job; } );
+      if( _stopping )
+         return;
+      last_job = _job_number;
+      if( _trxs == nullptr )
+         continue;
+
+      ++_busy;
+      lock.unlock();
+      run_job();
+      lock.lock();
+      if( --_busy == 0 )
+         _job_done.notify_all();
+   }
+}
+
+} }
@@ -33,6 +33,38 @@ namespace graphene { namespace db {
    class object_database;
    using fc::path;
 
+   /**
+    * @class index_file_writer
+    * @brief Buffered writer of an index file for fc::raw::pack, which appends a checksum of all bytes written.
+    */
+   class index_file_writer
+   {
+      public:
+         explicit index_file_writer( const fc::path& file );
+         /// appends to @p content instead of a file, which can then be written from any thread
+         explicit index_file_writer( vector<char>& content );
+
+         void write( const char* data, size_t size );
+         void put( char c ) { write( &c, 1 ); }
+
+         /// writes the buffered bytes and the checksum, the file is incomplete without this
+         void finish();
+
+      private:
+         void flush_buffer();
+
+         std::ofstream        _out;
+         vector<char>*        _content = nullptr;
+         vector<char>         _buffer;
+         fc::sha256::encoder  _checksum;
+   };
+
+   /**
+    * @return a stream over the content of an index file written by @ref index_file_writer, after checking its
+    * checksum
+    */
+   fc::datastream<const char*> checked_index_file( const fc::path& file, const fc::mapped_region& region );
+
    /**
     * @class index_observer
     * @brief used to get callbacks when objects change
@@ -96,6 +128,13 @@ namespace graphene { namespace db {
          virtual void open( const fc::path& db ) = 0;
          virtual void save( const fc::path& db ) = 0;
 
+         /**
+          *  Writes the next id and all objects to a snapshot of the object database, @ref load_snapshot reads them
+          *  back into an empty index
+          */
+         virtual void save_snapshot( index_file_writer& out )const = 0;
+         virtual void load_snapshot( fc::datastream<const char*>& ds ) = 0;
+
 
 
          /** @return the object with id or nullptr if not found */
@@ -219,52 +258,68 @@ namespace graphene { namespace db {
 
          fc::sha256 get_object_version()const
          {
-            std::string desc = "1.0";//get_type_description<object_type>();
+            std::string desc = "1.1";//get_type_description<object_type>();
             return fc::sha256::hash(desc);
          }
 
+         /**
+          * The file holds the next id and the version, then every object packed with its size in front, then the
+          * checksum. The objects are unpacked straight from the mapped file.
+          */
          virtual void open( const path& db )override
          { 
             if( !fc::exists( db ) ) return;
             fc::file_mapping fm( db.generic_string().c_str(), fc::read_only );
             fc::mapped_region mr( fm, fc::read_only, 0, fc::file_size(db) );
-            fc::datastream<const char*> ds( (const char*)mr.get_address(), mr.get_size() );
+            fc::datastream<const char*> ds = checked_index_file( db, mr );
             fc::sha256 open_ver;
 
             fc::raw::unpack(ds, _next_id);
             fc::raw::unpack(ds, open_ver);
             FC_ASSERT( open_ver == get_object_version(), "Incompatible Version, the serialization of objects in this index has changed" );
-            try {
-               vector<char> tmp;
-               while( true ) 
-               {
-                  fc::raw::unpack( ds, tmp );
-                  load( tmp );
-               }
-            } catch ( const fc::exception&  ){}
+            while( ds.remaining() > 0 )
+               load_record( ds );
          }
 
          virtual void save( const path& db ) override 
          {
-            std::ofstream out( db.generic_string(), 
-                               std::ofstream::binary | std::ofstream::out | std::ofstream::trunc );
-            FC_ASSERT( out );
+            index_file_writer out( db );
             auto ver  = get_object_version();
             fc::raw::pack( out, _next_id );
             fc::raw::pack( out, ver );
-            this->inspect_all_objects( [&]( const object& o ) {
-                auto vec = fc::raw::pack( static_cast<const object_type&>(o) );
-                auto packed_vec = fc::raw::pack( vec );
-                out.write( packed_vec.data(), packed_vec.size() );
-            });
+            this->inspect_all_objects( [&]( const object& o ) { save_record( out, o ); } );
+            out.finish();
+         }
+
+         /**
+          * The same records as in the index file, with their count in front instead of the end of the file behind
+          * them.
+          */
+         virtual void save_snapshot( index_file_writer& out )const override
+         {
+            uint64_t count = 0;
+            this->inspect_all_objects( [&]( const object& ) { ++count; } );
+            fc::raw::pack( out, _next_id );
+            fc::raw::pack( out, get_object_version() );
+            fc::raw::pack( out, count );
+            this->inspect_all_objects( [&]( const object& o ) { save_record( out, o ); } );
+         }
+
+         virtual void load_snapshot( fc::datastream<const char*>& ds )override
+         {
+            fc::sha256 snapshot_ver;
+            uint64_t count = 0;
+            fc::raw::unpack( ds, _next_id );
+            fc::raw::unpack( ds, snapshot_ver );
+            FC_ASSERT( snapshot_ver == get_object_version(), "Incompatible Version, the serialization of objects in this index has changed" );
+            fc::raw::unpack( ds, count );
+            for( uint64_t i = 0; i < count; ++i )
+               load_record( ds );
          }
 
          virtual const object&  load( const std::vector<char>& data )override
          {
-            const auto& result = DerivedIndex::insert( fc::raw::unpack<object_type>( data ) );
-            for( const auto& item : _sindex )
-               item->object_inserted( result );
-            return result;
+            return insert_loaded( fc::raw::unpack<object_type>( data ) );
          }
 
 
@@ -320,6 +375,36 @@ namespace graphene { namespace db {
          }
 
       private:
+         static void save_record( index_file_writer& out, const object& o )
+         {
+            const object_type& obj = static_cast<const object_type&>(o);
+            fc::raw::pack( out, fc::unsigned_int( fc::raw::pack_size( obj ) ) );
+            fc::raw::pack( out, obj );
+         }
+
+         void load_record( fc::datastream<const char*>& ds )
+         {
+            fc::unsigned_int size;
+            fc::raw::unpack( ds, size );
+            FC_ASSERT( size.value <= ds.remaining(), "Truncated object in index ${s}.${t}",
+                       ("s",object_type::space_id)("t",object_type::type_id) );
+            fc::datastream<const char*> record( ds.pos(), size.value );
+            object_type obj;
+            fc::raw::unpack( record, obj );
+            FC_ASSERT( record.remaining() == 0, "Object size mismatch in index ${s}.${t}",
+                       ("s",object_type::space_id)("t",object_type::type_id) );
+            ds.skip( size.value );
+            insert_loaded( std::move( obj ) );
+         }
+
+         const object& insert_loaded( object_type&& obj )
+         {
+            const auto& result = DerivedIndex::insert( std::move( obj ) );
+            for( const auto& item : _sindex )
+               item->object_inserted( result );
+            return result;
+         }
+
          object_id_type _next_id;
    };
 
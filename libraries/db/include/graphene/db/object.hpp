@@ -75,6 +75,8 @@ namespace graphene { namespace db {
          virtual void               move_from( object& obj ) = 0;
          virtual variant            to_variant()const  = 0;
          virtual vector<char>       pack()const = 0;
+         /// replaces the whole value of this object with the one packed in @p data
+         virtual void               unpack( const vector<char>& data ) = 0;
          virtual fc::uint128        hash()const = 0;
    };
 
@@ -100,6 +102,12 @@ namespace graphene { namespace db {
          }
          virtual variant to_variant()const { return variant( static_cast<const DerivedClass&>(*this) ); }
          virtual vector<char> pack()const  { return fc::raw::pack( static_cast<const DerivedClass&>(*this) ); }
+         virtual void         unpack( const vector<char>& data )
+         {
+            DerivedClass tmp;
+            fc::raw::unpack( data, tmp );
+            static_cast<DerivedClass&>(*this) = std::move( tmp );
+         }
          virtual fc::uint128  hash()const  {  
              auto tmp = this->pack();
              return fc::city_hash_crc_128( tmp.data(), tmp.size() );
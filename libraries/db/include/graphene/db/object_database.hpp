@@ -53,6 +53,13 @@ namespace graphene { namespace db {
          void wipe(const fc::path& data_dir); // remove from disk
          void close();
 
+         /**
+          * Writes every index to @p out, each behind its space and type id. @ref load_snapshot fills the empty
+          * indexes of a database with the same set of indexes from it.
+          */
+         void save_snapshot( index_file_writer& out )const;
+         void load_snapshot( fc::datastream<const char*>& ds );
+
          template<typename T, typename F>
          const T& create( F&& constructor )
          {
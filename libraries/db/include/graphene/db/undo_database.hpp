@@ -24,6 +24,7 @@
 #pragma once
 #include <graphene/db/object.hpp>
 #include <deque>
+#include <memory>
 #include <fc/exception/exception.hpp>
 
 namespace graphene { namespace db {
@@ -32,12 +33,100 @@ namespace graphene { namespace db {
    using fc::flat_set;
    class object_database;
 
+   /**
+    * The previous value of a modified object, kept as the bytes in which its packed form differs from the packed
+    * form of the value the object had when the delta was taken.
+    */
+   struct undo_delta
+   {
+      uint32_t      prefix = 0;  ///< leading bytes both packed forms share
+      uint32_t      suffix = 0;  ///< trailing bytes both packed forms share, not overlapping the prefix
+      uint32_t      size   = 0;  ///< size of the packed form the delta applies to
+      vector<char>  middle;      ///< the previous bytes between the shared ones
+
+      static undo_delta diff( const vector<char>& previous, const vector<char>& current );
+      /** @return the previous packed form, @p current has to be the packed form the delta was taken against */
+      vector<char>      apply( const vector<char>& current )const;
+   };
+
+   /**
+    * Blocks carved from large chunks and kept on free lists by size, shared by all undo states of one undo_database.
+    * The nodes a finished state releases are taken by the next ones instead of going back to the heap, so once the
+    * pool has grown to the working size applying blocks and pending transactions does not allocate. The chunks are
+    * only returned to the heap with the pool. Not thread safe, as the undo database itself.
+    */
+   class undo_pool
+   {
+      public:
+         undo_pool() {}
+         undo_pool( const undo_pool& ) = delete;
+         undo_pool& operator = ( const undo_pool& ) = delete;
+
+         void* allocate( size_t bytes );
+         void  deallocate( void* p, size_t bytes );
+
+      private:
+         static const size_t granularity = 16;
+         static const size_t max_block   = 512;
+         static const size_t chunk_size  = 64 * 1024;
+
+         struct free_block { free_block* next; };
+
+         free_block*                            _free[max_block / granularity] = {};
+         std::vector< std::unique_ptr<char[]> > _chunks;
+         size_t                                 _chunk_used = chunk_size;
+   };
+
+   /**
+    * Allocates the nodes and buckets of the undo state containers from an @ref undo_pool.
+    */
+   template<typename T>
+   class undo_allocator
+   {
+      public:
+         typedef T value_type;
+
+         explicit undo_allocator( undo_pool& pool ) : _pool( &pool ) {}
+         template<typename U>
+         undo_allocator( const undo_allocator<U>& other ) : _pool( other._pool ) {}
+
+         T*   allocate( size_t n )          { return static_cast<T*>( _pool->allocate( n * sizeof(T) ) ); }
+         void deallocate( T* p, size_t n )  { _pool->deallocate( p, n * sizeof(T) ); }
+
+         template<typename U>
+         bool operator == ( const undo_allocator<U>& o )const { return _pool == o._pool; }
+         template<typename U>
+         bool operator != ( const undo_allocator<U>& o )const { return _pool != o._pool; }
+
+      private:
+         template<typename U> friend class undo_allocator;
+         undo_pool* _pool;
+   };
+
+   template<typename Value>
+   using undo_map = unordered_map< object_id_type, Value, std::hash<object_id_type>, std::equal_to<object_id_type>,
+                                   undo_allocator< std::pair<const object_id_type, Value> > >;
+
    struct undo_state
    {
-      unordered_map<object_id_type, unique_ptr<object> > old_values;
-      unordered_map<object_id_type, object_id_type>      old_index_next_ids;
-      std::unordered_set<object_id_type>                 new_ids;
-      unordered_map<object_id_type, unique_ptr<object> > removed;
+      explicit undo_state( undo_pool& pool )
+         : old_values( undo_allocator<char>( pool ) ), old_index_next_ids( undo_allocator<char>( pool ) ),
+           new_ids( undo_allocator<char>( pool ) ), removed( undo_allocator<char>( pool ) ),
+           old_deltas( undo_allocator<char>( pool ) ) {}
+
+      bool empty()const
+      {
+         return old_values.empty() && old_index_next_ids.empty() && new_ids.empty() && removed.empty() && old_deltas.empty();
+      }
+
+      undo_map< unique_ptr<object> >    old_values;
+      undo_map< object_id_type >        old_index_next_ids;
+      std::unordered_set< object_id_type, std::hash<object_id_type>, std::equal_to<object_id_type>,
+                          undo_allocator<object_id_type> > new_ids;
+      undo_map< unique_ptr<object> >    removed;
+      /// previous values of the modified objects whose type stores deltas, taken against the current values
+      /// once no session was active anymore, an id is never in both old_values and old_deltas
+      undo_map< undo_delta >            old_deltas;
    };
 
 
@@ -132,16 +221,45 @@ namespace graphene { namespace db {
 
          const undo_state& head()const;
 
+         /**
+          * @return the number of objects of the given type whose previous value has been copied into the head
+          * undo state, either because they were modified or removed
+          */
+         size_t cloned_objects( uint8_t space_id, uint8_t type_id )const;
+
+         /**
+          * Keep the previous values of modified objects of the given type as deltas of their packed form instead
+          * of full copies. The copy taken on the first modification is turned into a delta when the next session
+          * is started after all sessions were committed, so the undo history kept for fork switching holds only
+          * the changed bytes of large objects while the sessions of the block being applied stay as cheap as before.
+          */
+         void store_deltas( uint8_t space_id, uint8_t type_id );
+
+         /**
+          * @return the packed size of all previous values held in the undo history, a measure of its memory
+          * that does not depend on how the objects are laid out in memory
+          */
+         size_t stored_bytes()const;
+
       private:
          void undo();
          void merge();
          void commit();
 
+         /// reverts the objects to the values recorded in @p state, which has to be the last state
+         void restore( undo_state& state );
+         /// turns the copies of the types storing deltas into deltas against the current values
+         void compact( undo_state& state );
+         /// @return a copy of the value @p delta was taken from, @p current is the value it was taken against
+         unique_ptr<object> expand( const object& current, const undo_delta& delta )const;
+
          uint32_t                _active_sessions = 0;
          bool                    _disabled = true;
+         undo_pool               _pool;
          std::deque<undo_state>  _stack;
          object_database&        _db;
          size_t                  _max_size = 256;
+         flat_set<object_id_type> _delta_types;
    };
 
 } } // graphene::db
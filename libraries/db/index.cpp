@@ -40,4 +40,59 @@ namespace graphene { namespace db {
 
    void base_primary_index::on_modify( const object& obj )
    {for( auto ob : _observers ) ob->on_modify(  obj ); }
+
+   index_file_writer::index_file_writer( const fc::path& file )
+   : _out( file.generic_string(), std::ofstream::binary | std::ofstream::out | std::ofstream::trunc )
+   {
+      FC_ASSERT( _out, "Unable to write ${file}", ("file",file) );
+      _buffer.reserve( 1024 * 1024 );
+   }
+
+   index_file_writer::index_file_writer( vector<char>& content )
+   : _content( &content )
+   {
+      _buffer.reserve( 1024 * 1024 );
+   }
+
+   void index_file_writer::write( const char* data, size_t size )
+   {
+      if( _buffer.size() + size > _buffer.capacity() )
+         flush_buffer();
+      _buffer.insert( _buffer.end(), data, data + size );
+   }
+
+   void index_file_writer::flush_buffer()
+   {
+      _checksum.write( _buffer.data(), _buffer.size() );
+      if( _content != nullptr )
+         _content->insert( _content->end(), _buffer.begin(), _buffer.end() );
+      else
+         _out.write( _buffer.data(), _buffer.size() );
+      _buffer.clear();
+   }
+
+   void index_file_writer::finish()
+   {
+      flush_buffer();
+      fc::sha256 checksum = _checksum.result();
+      if( _content != nullptr )
+      {
+         _content->insert( _content->end(), checksum.data(), checksum.data() + checksum.data_size() );
+         return;
+      }
+      _out.write( checksum.data(), checksum.data_size() );
+      _out.close();
+      FC_ASSERT( !_out.fail(), "Unable to write index file" );
+   }
+
+   fc::datastream<const char*> checked_index_file( const fc::path& file, const fc::mapped_region& region )
+   {
+      const char* data = (const char*)region.get_address();
+      size_t size = region.get_size();
+      FC_ASSERT( size >= sizeof( fc::sha256 ), "Truncated index file ${file}", ("file",file) );
+      size -= sizeof( fc::sha256 );
+      FC_ASSERT( fc::sha256::hash( data, size ) == fc::sha256( data + size, sizeof( fc::sha256 ) ),
+                 "Checksum mismatch in index file ${file}", ("file",file) );
+      return fc::datastream<const char*>( data, size );
+   }
 } } // graphene::chain
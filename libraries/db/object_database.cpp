@@ -27,6 +27,11 @@
 #include <fc/container/flat.hpp>
 #include <fc/uint128.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
 namespace graphene { namespace db {
 
 object_database::object_database()
@@ -68,18 +73,57 @@ index& object_database::get_mutable_index(uint8_t space_id, uint8_t type_id)
    return *idx;
 }
 
+namespace {
+   /**
+    * Runs @p task for every index, spread over as many threads as there are cores. The indexes do not share
+    * state, so they can be saved or loaded at the same time. The exception of the first failed index is rethrown
+    * once all threads are done.
+    */
+   void for_each_index_in_parallel( const vector<index*>& indexes, const std::function<void(index&)>& task )
+   {
+      std::atomic<size_t> next( 0 );
+      vector<std::exception_ptr> errors( indexes.size() );
+      auto worker = [&]() {
+         for( size_t i = next++; i < indexes.size(); i = next++ )
+         {
+            try {
+               task( *indexes[i] );
+            } catch( ... ) {
+               errors[i] = std::current_exception();
+            }
+         }
+      };
+
+      size_t thread_count = std::min<size_t>( std::max( 1u, std::thread::hardware_concurrency() ), indexes.size() );
+      vector<std::thread> threads;
+      for( size_t i = 1; i < thread_count; ++i )
+         threads.emplace_back( worker );
+      worker();
+      for( auto& thread : threads )
+         thread.join();
+
+      for( const auto& error : errors )
+         if( error )
+            std::rethrow_exception( error );
+   }
+}
+
 void object_database::flush()
 {
 //   ilog("Save object_database in ${d}", ("d", _data_dir));
    fc::create_directories( _data_dir / "object_database.tmp" / "lock" );
+   vector<index*> indexes;
    for( uint32_t space = 0; space < _index.size(); ++space )
    {
       fc::create_directories( _data_dir / "object_database.tmp" / fc::to_string(space) );
       const auto types = _index[space].size();
       for( uint32_t type = 0; type  <  types; ++type )
          if( _index[space][type] )
-            _index[space][type]->save( _data_dir / "object_database.tmp" / fc::to_string(space)/fc::to_string(type) );
+            indexes.push_back( _index[space][type].get() );
    }
+   for_each_index_in_parallel( indexes, [this]( index& idx ) {
+      idx.save( _data_dir / "object_database.tmp" / fc::to_string(idx.object_space_id()) / fc::to_string(idx.object_type_id()) );
+   });
    fc::remove_all( _data_dir / "object_database.tmp" / "lock" );
    if( fc::exists( _data_dir / "object_database" ) )
       fc::rename( _data_dir / "object_database", _data_dir / "object_database.old" );
@@ -104,15 +148,53 @@ void object_database::open(const fc::path& data_dir)
        return;
    }
    ilog("Opening object database from ${d} ...", ("d", data_dir));
+   vector<index*> indexes;
    for( uint32_t space = 0; space < _index.size(); ++space )
       for( uint32_t type = 0; type  < _index[space].size(); ++type )
          if( _index[space][type] )
-            _index[space][type]->open( _data_dir / "object_database" / fc::to_string(space)/fc::to_string(type) );
+            indexes.push_back( _index[space][type].get() );
+   for_each_index_in_parallel( indexes, [this]( index& idx ) {
+      idx.open( _data_dir / "object_database" / fc::to_string(idx.object_space_id()) / fc::to_string(idx.object_type_id()) );
+   });
    ilog( "Done opening object database." );
 
 } FC_CAPTURE_AND_RETHROW( (data_dir) ) }
 
 
+void object_database::save_snapshot( index_file_writer& out )const
+{ try {
+   vector<const index*> indexes;
+   for( const auto& space : _index )
+      for( const auto& idx : space )
+         if( idx )
+            indexes.push_back( idx.get() );
+
+   fc::raw::pack( out, fc::unsigned_int( indexes.size() ) );
+   for( const index* idx : indexes )
+   {
+      fc::raw::pack( out, idx->object_space_id() );
+      fc::raw::pack( out, idx->object_type_id() );
+      idx->save_snapshot( out );
+   }
+} FC_CAPTURE_AND_RETHROW() }
+
+void object_database::load_snapshot( fc::datastream<const char*>& ds )
+{ try {
+   fc::unsigned_int count;
+   fc::raw::unpack( ds, count );
+   for( uint32_t i = 0; i < count.value; ++i )
+   {
+      uint8_t space_id = 0;
+      uint8_t type_id = 0;
+      fc::raw::unpack( ds, space_id );
+      fc::raw::unpack( ds, type_id );
+      FC_ASSERT( _index.size() > space_id && _index[space_id].size() > type_id && _index[space_id][type_id],
+                 "The snapshot holds an index this database does not have", ("space",space_id)("type",type_id) );
+      _index[space_id][type_id]->load_snapshot( ds );
+   }
+   FC_ASSERT( ds.remaining() == 0, "Unexpected data after the last index of the snapshot" );
+} FC_CAPTURE_AND_RETHROW() }
+
 void object_database::pop_undo()
 { try {
    _undo_db.pop_commit();
@@ -25,8 +25,48 @@
 #include <graphene/db/undo_database.hpp>
 #include <fc/reflect/variant.hpp>
 
+#include <algorithm>
+
 namespace graphene { namespace db {
 
+void* undo_pool::allocate( size_t bytes )
+{
+   if( bytes > max_block )
+      return ::operator new( bytes );
+
+   size_t slot = ( bytes + granularity - 1 ) / granularity - 1;
+   if( _free[slot] != nullptr )
+   {
+      free_block* block = _free[slot];
+      _free[slot] = block->next;
+      return block;
+   }
+
+   size_t size = ( slot + 1 ) * granularity;
+   if( _chunk_used + size > chunk_size )
+   {
+      _chunks.emplace_back( new char[chunk_size] );
+      _chunk_used = 0;
+   }
+   void* block = _chunks.back().get() + _chunk_used;
+   _chunk_used += size;
+   return block;
+}
+
+void undo_pool::deallocate( void* p, size_t bytes )
+{
+   if( bytes > max_block )
+   {
+      ::operator delete( p );
+      return;
+   }
+
+   size_t slot = ( bytes + granularity - 1 ) / granularity - 1;
+   free_block* block = static_cast<free_block*>( p );
+   block->next = _free[slot];
+   _free[slot] = block;
+}
+
 void undo_database::enable()  { _disabled = false; }
 void undo_database::disable() { _disabled = true; }
 
@@ -40,7 +80,11 @@ undo_database::session undo_database::start_undo_session( bool force_enable )
    while( size() > max_size() )
       _stack.pop_front();
 
-   _stack.emplace_back();
+   // the last state is complete once all of its sessions are committed
+   if( _active_sessions == 0 && !_stack.empty() && !_delta_types.empty() )
+      compact( _stack.back() );
+
+   _stack.emplace_back( _pool );
    ++_active_sessions;
    return session(*this, disable_on_exit );
 }
@@ -49,7 +93,7 @@ void undo_database::on_create( const object& obj )
    if( _disabled ) return;
 
    if( _stack.empty() )
-      _stack.emplace_back();
+      _stack.emplace_back( _pool );
    auto& state = _stack.back();
    auto index_id = object_id_type( obj.id.space(), obj.id.type(), 0 );
    auto itr = state.old_index_next_ids.find( index_id );
@@ -62,12 +106,20 @@ void undo_database::on_modify( const object& obj )
    if( _disabled ) return;
 
    if( _stack.empty() )
-      _stack.emplace_back();
+      _stack.emplace_back( _pool );
    auto& state = _stack.back();
    if( state.new_ids.find(obj.id) != state.new_ids.end() )
       return;
    auto itr =  state.old_values.find(obj.id);
    if( itr != state.old_values.end() ) return;
+   // a delta only applies to the value it was taken against, which is about to change
+   auto delta = state.old_deltas.find(obj.id);
+   if( delta != state.old_deltas.end() )
+   {
+      state.old_values[obj.id] = expand( obj, delta->second );
+      state.old_deltas.erase(delta);
+      return;
+   }
    state.old_values[obj.id] = obj.clone();
 }
 void undo_database::on_remove( const object& obj )
@@ -75,7 +127,7 @@ void undo_database::on_remove( const object& obj )
    if( _disabled ) return;
 
    if( _stack.empty() )
-      _stack.emplace_back();
+      _stack.emplace_back( _pool );
    undo_state& state = _stack.back();
    if( state.new_ids.count(obj.id) )
    {
@@ -88,6 +140,13 @@ void undo_database::on_remove( const object& obj )
       state.old_values.erase(obj.id);
       return;
    }
+   auto delta = state.old_deltas.find(obj.id);
+   if( delta != state.old_deltas.end() )
+   {
+      state.removed[obj.id] = expand( obj, delta->second );
+      state.old_deltas.erase(delta);
+      return;
+   }
    if( state.removed.count(obj.id) ) return;
    state.removed[obj.id] = obj.clone();
 }
@@ -98,24 +157,7 @@ void undo_database::undo()
    FC_ASSERT( _active_sessions > 0 );
    disable();
 
-   auto& state = _stack.back();
-   for( auto& item : state.old_values )
-   {
-      _db.modify( _db.get_object( item.second->id ), [&]( object& obj ){ obj.move_from( *item.second ); } );
-   }
-
-   for( auto ritr = state.new_ids.begin(); ritr != state.new_ids.end(); ++ritr  )
-   {
-      _db.remove( _db.get_object(*ritr) );
-   }
-
-   for( auto& item : state.old_index_next_ids )
-   {
-      _db.get_mutable_index( item.first.space(), item.first.type() ).set_next_id( item.second );
-   }
-
-   for( auto& item : state.removed )
-      _db.insert( std::move(*item.second) );
+   restore( _stack.back() );
 
    _stack.pop_back();
    enable();
@@ -135,6 +177,40 @@ void undo_database::merge()
    auto& state = _stack.back();
    auto& prev_state = _stack[_stack.size()-2];
 
+   // Merging into an empty state is type B for every object, as with the first transaction of a block, so the
+   // containers are swapped instead of being rehashed entry by entry.
+   if( prev_state.empty() )
+   {
+      std::swap( prev_state, state );
+      _stack.pop_back();
+      --_active_sessions;
+      return;
+   }
+
+   // The deltas of state are taken against the current values, so they are valid copies for the merged state.
+   // The deltas of prev_state are taken against the values state starts from, which are the copies in state for
+   // the objects state modified or removed, and the current values for all others.
+   for( auto& item : state.old_deltas )
+      state.old_values[item.first] = expand( _db.get_object( item.first ), item.second );
+   state.old_deltas.clear();
+   for( auto itr = prev_state.old_deltas.begin(); itr != prev_state.old_deltas.end(); )
+   {
+      auto upd = state.old_values.find( itr->first );
+      if( upd != state.old_values.end() )
+         prev_state.old_values[itr->first] = expand( *upd->second, itr->second );
+      else
+      {
+         auto del = state.removed.find( itr->first );
+         if( del == state.removed.end() )
+         {
+            ++itr;
+            continue;
+         }
+         prev_state.old_values[itr->first] = expand( *del->second, itr->second );
+      }
+      itr = prev_state.old_deltas.erase( itr );
+   }
+
    // An object's relationship to a state can be:
    // in new_ids            : new
    // in old_values (was=X) : upd(was=X)
@@ -255,25 +331,7 @@ void undo_database::pop_commit()
 
    disable();
    try {
-      auto& state = _stack.back();
-
-      for( auto& item : state.old_values )
-      {
-         _db.modify( _db.get_object( item.second->id ), [&]( object& obj ){ obj.move_from( *item.second ); } );
-      }
-
-      for( auto ritr = state.new_ids.begin(); ritr != state.new_ids.end(); ++ritr  )
-      {
-         _db.remove( _db.get_object(*ritr) );
-      }
-
-      for( auto& item : state.old_index_next_ids )
-      {
-         _db.get_mutable_index( item.first.space(), item.first.type() ).set_next_id( item.second );
-      }
-
-      for( auto& item : state.removed )
-         _db.insert( std::move(*item.second) );
+      restore( _stack.back() );
 
       _stack.pop_back();
    }
@@ -291,4 +349,115 @@ const undo_state& undo_database::head()const
    return _stack.back();
 }
 
+size_t undo_database::cloned_objects( uint8_t space_id, uint8_t type_id )const
+{
+   if( _stack.empty() ) return 0;
+   const undo_state& state = _stack.back();
+   size_t count = 0;
+   for( const auto& item : state.old_values )
+      if( item.first.space() == space_id && item.first.type() == type_id )
+         ++count;
+   for( const auto& item : state.removed )
+      if( item.first.space() == space_id && item.first.type() == type_id )
+         ++count;
+   for( const auto& item : state.old_deltas )
+      if( item.first.space() == space_id && item.first.type() == type_id )
+         ++count;
+   return count;
+}
+
+void undo_database::store_deltas( uint8_t space_id, uint8_t type_id )
+{
+   _delta_types.insert( object_id_type( space_id, type_id, 0 ) );
+}
+
+size_t undo_database::stored_bytes()const
+{
+   size_t bytes = 0;
+   for( const undo_state& state : _stack )
+   {
+      for( const auto& item : state.old_values )
+         bytes += item.second->pack().size();
+      for( const auto& item : state.removed )
+         bytes += item.second->pack().size();
+      for( const auto& item : state.old_deltas )
+         bytes += sizeof( undo_delta ) + item.second.middle.size();
+   }
+   return bytes;
+}
+
+void undo_database::restore( undo_state& state )
+{
+   for( auto& item : state.old_values )
+   {
+      _db.modify( _db.get_object( item.second->id ), [&]( object& obj ){ obj.move_from( *item.second ); } );
+   }
+
+   for( auto& item : state.old_deltas )
+   {
+      const object& current = _db.get_object( item.first );
+      vector<char> previous = item.second.apply( current.pack() );
+      _db.modify( current, [&]( object& obj ){ obj.unpack( previous ); } );
+   }
+
+   for( auto ritr = state.new_ids.begin(); ritr != state.new_ids.end(); ++ritr  )
+   {
+      _db.remove( _db.get_object(*ritr) );
+   }
+
+   for( auto& item : state.old_index_next_ids )
+   {
+      _db.get_mutable_index( item.first.space(), item.first.type() ).set_next_id( item.second );
+   }
+
+   for( auto& item : state.removed )
+      _db.insert( std::move(*item.second) );
+}
+
+void undo_database::compact( undo_state& state )
+{
+   for( auto itr = state.old_values.begin(); itr != state.old_values.end(); )
+   {
+      if( _delta_types.find( object_id_type( itr->first.space(), itr->first.type(), 0 ) ) == _delta_types.end() )
+      {
+         ++itr;
+         continue;
+      }
+      state.old_deltas[itr->first] = undo_delta::diff( itr->second->pack(), _db.get_object( itr->first ).pack() );
+      itr = state.old_values.erase( itr );
+   }
+}
+
+unique_ptr<object> undo_database::expand( const object& current, const undo_delta& delta )const
+{
+   unique_ptr<object> result = current.clone();
+   result->unpack( delta.apply( current.pack() ) );
+   return result;
+}
+
+undo_delta undo_delta::diff( const vector<char>& previous, const vector<char>& current )
+{
+   undo_delta delta;
+   size_t shared = std::min( previous.size(), current.size() );
+   while( delta.prefix < shared && previous[delta.prefix] == current[delta.prefix] )
+      ++delta.prefix;
+   shared -= delta.prefix;
+   while( delta.suffix < shared && previous[previous.size() - delta.suffix - 1] == current[current.size() - delta.suffix - 1] )
+      ++delta.suffix;
+   delta.size = current.size();
+   delta.middle.assign( previous.begin() + delta.prefix, previous.end() - delta.suffix );
+   return delta;
+}
+
+vector<char> undo_delta::apply( const vector<char>& current )const
+{
+   FC_ASSERT( current.size() == size, "undo delta taken against another value" );
+   vector<char> previous;
+   previous.reserve( prefix + middle.size() + suffix );
+   previous.insert( previous.end(), current.begin(), current.begin() + prefix );
+   previous.insert( previous.end(), middle.begin(), middle.end() );
+   previous.insert( previous.end(), current.end() - suffix, current.end() );
+   return previous;
+}
+
 } } // graphene::db
@@ -36,6 +36,7 @@ namespace bpo = boost::program_options;
 static const char* OPT_BLOCK_NUM  = "snapshot-at-block";
 static const char* OPT_BLOCK_TIME = "snapshot-at-time";
 static const char* OPT_DEST       = "snapshot-to";
+static const char* OPT_FORMAT     = "snapshot-format";
 
 void snapshot_plugin::plugin_set_program_options(
    boost::program_options::options_description& command_line_options,
@@ -44,7 +45,11 @@ void snapshot_plugin::plugin_set_program_options(
    command_line_options.add_options()
          (OPT_BLOCK_NUM, bpo::value<uint32_t>(), "Block number after which to do a snapshot")
          (OPT_BLOCK_TIME, bpo::value<string>(), "Block time (ISO format) after which to do a snapshot")
-         (OPT_DEST, bpo::value<string>(), "Pathname of JSON file where to store the snapshot")
+         (OPT_DEST, bpo::value<string>(), "Pathname of the file where to store the snapshot")
+         (OPT_FORMAT, bpo::value<string>()->default_value("json"),
+          "Format of the snapshot: json for one object per line, binary for a snapshot a node can start from with "
+          "load-snapshot. A binary snapshot is packed in memory when its block is applied and written by another "
+          "thread once the block is irreversible, it is dropped if the block is switched away from before")
          ;
    config_file_options.add(command_line_options);
 }
@@ -67,6 +72,9 @@ void snapshot_plugin::plugin_initialize(const boost::program_options::variables_
    {
       FC_ASSERT( options.count(OPT_DEST), "Must specify snapshot-to in addition to snapshot-at-block or snapshot-at-time!" );
       dest = options[OPT_DEST].as<std::string>();
+      const string format = options[OPT_FORMAT].as<string>();
+      FC_ASSERT( format == "json" || format == "binary", "Unknown snapshot-format ${f}", ("f",format) );
+      binary = format == "binary";
       if( options.count(OPT_BLOCK_NUM) )
          snapshot_block = options[OPT_BLOCK_NUM].as<uint32_t>();
       if( options.count(OPT_BLOCK_TIME) )
@@ -82,7 +90,14 @@ void snapshot_plugin::plugin_initialize(const boost::program_options::variables_
 
 void snapshot_plugin::plugin_startup() {}
 
-void snapshot_plugin::plugin_shutdown() {}
+void snapshot_plugin::plugin_shutdown()
+{
+   if( pending.valid() )
+      wlog( "snapshot plugin: block ${n} did not become irreversible, its snapshot is not written",
+            ("n",graphene::chain::block_header::num_from_id( pending->block_id )) );
+   if( writer.joinable() )
+      writer.join();
+}
 
 static void create_snapshot( const graphene::chain::database& db, const fc::path& dest )
 {
@@ -120,9 +135,67 @@ static void create_snapshot( const graphene::chain::database& db, const fc::path
 void snapshot_plugin::check_snapshot( const graphene::chain::signed_block& b )
 { try {
     uint32_t current_block = b.block_num();
+    // a block applied again after a switch of forks can trigger the snapshot again
+    if( current_block <= last_block )
+    {
+       last_block = current_block - 1;
+       last_time = current_block > 1 ? database().fetch_block_by_id( b.previous )->timestamp : fc::time_point_sec(1);
+    }
     if( (last_block < snapshot_block && snapshot_block <= current_block)
            || (last_time < snapshot_time && snapshot_time <= b.timestamp) )
-       create_snapshot( database(), dest );
+    {
+       if( binary )
+       {
+          try
+          {
+             pending = pending_snapshot{ b.id(), std::make_shared<std::vector<char>>( database().pack_snapshot() ) };
+             ilog( "snapshot plugin: packed snapshot of block ${n}, writing it once the block is irreversible",
+                   ("n",current_block) );
+          }
+          catch( const fc::exception& e )
+          {
+             elog( "Failed to pack snapshot: ${ex}", ("ex",e.to_detail_string()) );
+          }
+       }
+       else
+          create_snapshot( database(), dest );
+    }
     last_block = current_block;
     last_time = b.timestamp;
+
+    if( pending.valid() )
+       write_pending_snapshot();
 } FC_LOG_AND_RETHROW() }
+
+void snapshot_plugin::write_pending_snapshot()
+{
+    const graphene::chain::database& db = database();
+    uint32_t block_num = graphene::chain::block_header::num_from_id( pending->block_id );
+    if( db.get_dynamic_global_properties().last_irreversible_block_num < block_num )
+       return;
+
+    pending_snapshot snapshot = *pending;
+    pending.reset();
+    auto block = db.fetch_block_by_number( block_num );
+    if( !block.valid() || block->id() != snapshot.block_id )
+    {
+       elog( "snapshot plugin: block ${n} was switched away from before it became irreversible, its snapshot is "
+             "not written", ("n",block_num) );
+       return;
+    }
+
+    // the content is complete, writing it needs nothing from the database
+    if( writer.joinable() )
+       writer.join();
+    const fc::path file = dest;
+    writer = std::thread( [file,snapshot]() {
+       try
+       {
+          graphene::chain::database::write_snapshot( file, *snapshot.content );
+       }
+       catch( const fc::exception& e )
+       {
+          elog( "Failed to write snapshot: ${ex}", ("ex",e.to_detail_string()) );
+       }
+    });
+}
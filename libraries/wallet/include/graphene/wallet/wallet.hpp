@@ -837,11 +837,40 @@ class wallet_api
                                                                       uint32_t status
                                                                     ) const;                                                                    
 
+      /** Returns up to \c limit credit requests matching \c filter, newest first.
+       * @param start the \c next of the previous page, null for the first page
+       */
+      credit_request_page list_credit_requests( const credit_request_filter& filter,
+                                                optional<credit_request_cursor> start,
+                                                uint32_t limit )const;
+
       signed_transaction exchange_rate_set( string witness, 
                                             std::map<std::string, double> exch_rates,   
                                             bool broadcast = false );
 
-      std::vector<karma_history_entry> list_account_history_of_karma(std::string account_id)const;
+      /** Returns up to \c limit karma history entries of an account starting at sequence number \c start.
+       */
+      std::vector<karma_history_entry> list_account_history_of_karma(std::string account_id, uint32_t start, uint32_t limit)const;
+
+      /** Returns up to \c limit karma history entries of an account recorded between \c from and \c to.
+       */
+      std::vector<karma_history_entry> list_account_history_of_karma_by_time(std::string account_id, time_point_sec from, time_point_sec to, uint32_t limit)const;
+
+      /** Returns up to \c limit accounts with a karma between \c lower and \c upper, highest karma first.
+       */
+      vector<account_object> get_accounts_by_karma(float lower, float upper, uint32_t limit)const;
+
+      /** Returns the position of an account when all accounts are ordered by karma, highest first.
+       */
+      uint32_t get_karma_rank(std::string account_id)const;
+
+      /** Returns the totals of all credits in an asset.
+       */
+      optional<credit_statistics_object> get_credit_statistics(string asset_symbol_or_id)const;
+
+      /** Returns the totals of the credits of an account, one object per asset.
+       */
+      vector<account_credit_statistics_object> get_account_credit_statistics(std::string account_id)const;
 
       map<string, string> list_last_exchange_rates()const;
       map< std::string, std::map< account_id_type, string >> list_current_exchange_rates()const;
@@ -1738,7 +1767,13 @@ FC_API( graphene::wallet::wallet_api,
         (list_credit_request_by_uuid)
         (fetch_credit_requests_stack)
         (fetch_credit_requests_stack_by_creditor)
+        (list_credit_requests)
         (list_account_history_of_karma)
+        (list_account_history_of_karma_by_time)
+        (get_accounts_by_karma)
+        (get_karma_rank)
+        (get_credit_statistics)
+        (get_account_credit_statistics)
         (list_last_exchange_rates)
         (list_current_exchange_rates)
         (list_global_extensions)
@@ -3032,10 +3032,42 @@ vector<credit_object> wallet_api::fetch_credit_requests_stack_by_creditor( uint3
                                                           loan_volume_from, loan_volume_to, cyrrency_symbol, creditor_user_id, status );
 }
 
+credit_request_page wallet_api::list_credit_requests( const credit_request_filter& filter,
+                                                     optional<credit_request_cursor> start,
+                                                     uint32_t limit )const
+{
+      return my->_remote_db->list_credit_requests( filter, start, limit );
+}
+
+
+std::vector<karma_history_entry> wallet_api::list_account_history_of_karma(std::string account_id, uint32_t start, uint32_t limit) const
+{
+      return my->_remote_db->list_account_history_of_karma(account_id, start, limit);
+}
+
+std::vector<karma_history_entry> wallet_api::list_account_history_of_karma_by_time(std::string account_id, time_point_sec from, time_point_sec to, uint32_t limit) const
+{
+      return my->_remote_db->list_account_history_of_karma_by_time(account_id, from, to, limit);
+}
+
+vector<account_object> wallet_api::get_accounts_by_karma(float lower, float upper, uint32_t limit) const
+{
+      return my->_remote_db->get_accounts_by_karma(lower, upper, limit);
+}
+
+uint32_t wallet_api::get_karma_rank(std::string account_id) const
+{
+      return my->_remote_db->get_karma_rank(account_id);
+}
+
+optional<credit_statistics_object> wallet_api::get_credit_statistics(string asset_symbol_or_id) const
+{
+      return my->_remote_db->get_credit_statistics(asset_symbol_or_id);
+}
 
-std::vector<karma_history_entry> wallet_api::list_account_history_of_karma(std::string account_id) const
+vector<account_credit_statistics_object> wallet_api::get_account_credit_statistics(std::string account_id) const
 {
-      return my->_remote_db->list_account_history_of_karma(account_id);
+      return my->_remote_db->get_account_credit_statistics(account_id);
 }
 
 map<string, string> wallet_api::list_last_exchange_rates() const
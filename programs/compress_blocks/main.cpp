@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <fc/filesystem.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/smart_ref_impl.hpp>
+
+#include <graphene/chain/block_database.hpp>
+#include <graphene/chain/protocol/fee_schedule.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <iostream>
+
+using namespace graphene::chain;
+namespace bpo = boost::program_options;
+
+/**
+ * Copies the blocks of a block database into a new one that keeps them in compressed chunks. The node reads
+ * both formats, the blocks it produces or receives later are appended uncompressed.
+ */
+int main( int argc, char** argv )
+{
+   try
+   {
+      bpo::options_description cli_options("Compress the block database of a node");
+      cli_options.add_options()
+            ("help,h", "Print this help message and exit.")
+            ("input-dir,i", bpo::value<boost::filesystem::path>(), "Block database to read, data-dir/blockchain/database/block_num_to_block of a stopped node")
+            ("output-dir,o", bpo::value<boost::filesystem::path>(), "Directory to write the compressed block database to, has to be empty")
+            ("blocks-per-chunk", bpo::value<uint32_t>()->default_value(64), "Number of blocks compressed together")
+            ;
+
+      bpo::variables_map options;
+      try
+      {
+         boost::program_options::store( boost::program_options::parse_command_line(argc, argv, cli_options), options );
+      }
+      catch (const boost::program_options::error& e)
+      {
+         std::cerr << "compress_blocks:  error parsing command line: " << e.what() << "\n";
+         return 1;
+      }
+
+      if( options.count("help") )
+      {
+         std::cout << cli_options << "\n";
+         return 1;
+      }
+
+      if( !options.count( "input-dir" ) || !options.count( "output-dir" ) )
+      {
+         std::cerr << "--input-dir and --output-dir options are required\n";
+         return 1;
+      }
+
+      fc::path input_dir = options["input-dir"].as<boost::filesystem::path>();
+      fc::path output_dir = options["output-dir"].as<boost::filesystem::path>();
+      uint32_t blocks_per_chunk = options["blocks-per-chunk"].as<uint32_t>();
+      if( blocks_per_chunk == 0 )
+      {
+         std::cerr << "--blocks-per-chunk has to be at least 1\n";
+         return 1;
+      }
+      if( !fc::exists( input_dir / "index" ) )
+      {
+         std::cerr << "No block database in " << input_dir.preferred_string() << "\n";
+         return 1;
+      }
+      if( fc::exists( output_dir ) && !boost::filesystem::is_empty( output_dir ) )
+      {
+         std::cerr << output_dir.preferred_string() << " is not empty\n";
+         return 1;
+      }
+
+      block_database input;
+      input.open( input_dir );
+      optional<block_id_type> last_id = input.last_id();
+      if( !last_id.valid() )
+      {
+         std::cerr << "The block database is empty\n";
+         return 1;
+      }
+      uint32_t last_block_num = block_header::num_from_id( *last_id );
+
+      block_database output;
+      output.open( output_dir );
+
+      uint64_t raw_size = 0;
+      vector<signed_block> chunk;
+      chunk.reserve( blocks_per_chunk );
+      for( uint32_t block_num = 1; block_num <= last_block_num; ++block_num )
+      {
+         optional<signed_block> block = input.fetch_by_number( block_num );
+         if( !block.valid() )
+         {
+            std::cerr << "Block " << block_num << " is missing, stopping after block " << block_num - 1 << "\n";
+            break;
+         }
+         raw_size += fc::raw::pack_size( *block );
+         chunk.push_back( std::move( *block ) );
+         if( chunk.size() == blocks_per_chunk )
+         {
+            output.store_chunk( chunk );
+            chunk.clear();
+         }
+         if( block_num % 100000 == 0 )
+            std::cerr << "   " << block_num << " of " << last_block_num << " blocks\n";
+      }
+      output.store_chunk( chunk );
+      output.close();
+      input.close();
+
+      uint64_t compressed_size = fc::file_size( output_dir / "chunks" );
+      std::cout << "Blocks:     " << raw_size << " bytes\n"
+                << "Compressed: " << compressed_size << " bytes\n";
+   }
+   catch ( const fc::exception& e )
+   {
+      std::cerr << e.to_detail_string() << "\n";
+      return 1;
+   }
+   return 0;
+}
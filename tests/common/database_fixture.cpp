@@ -32,6 +32,7 @@
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/asset_object.hpp>
 #include <graphene/chain/committee_member_object.hpp>
+#include <graphene/chain/exchange_rate_object.hpp>
 #include <graphene/chain/fba_object.hpp>
 #include <graphene/chain/market_object.hpp>
 #include <graphene/chain/vesting_balance_object.hpp>
@@ -200,6 +201,8 @@ void database_fixture::verify_asset_supplies( const database& db )
       total_balances[ vbo.balance.asset_id ] += vbo.balance.amount;
    for( const fba_accumulator_object& fba : db.get_index_type< simple_index< fba_accumulator_object > >() )
       total_balances[ asset_id_type() ] += fba.accumulated_fba_fees;
+   for( const credit_object& c : db.get_index_type< credit_index >().indices() )
+      total_balances[ c.borrower.deposit_asset.asset_id ] += c.borrower.deposit_asset.amount;
 
    total_balances[asset_id_type()] += db.get_dynamic_global_properties().witness_budget;
 
@@ -725,6 +728,80 @@ asset database_fixture::cancel_limit_order( const limit_order_object& order )
   return processed.operation_results[0].get<asset>();
 }
 
+const credit_object& database_fixture::request_credit( account_id_type borrower, const asset& loan, const asset& deposit,
+                                                      uint32_t loan_period, uint32_t loan_persent )
+{ try {
+   set_expiration( db, trx );
+   trx.operations.clear();
+   credit_request_operation op;
+   op.fee = asset( 1 );
+   op.borrower = borrower;
+   op.loan_asset = loan;
+   op.loan_period = loan_period;
+   op.loan_persent = loan_persent;
+   op.deposit_asset = deposit;
+   trx.operations.push_back( op );
+   trx.validate();
+   processed_transaction ptx = db.push_transaction( trx, ~0 );
+   trx.operations.clear();
+   verify_asset_supplies( db );
+   return db.get<credit_object>( ptx.operation_results[0].get<object_id_type>() );
+} FC_CAPTURE_AND_RETHROW( (borrower)(loan)(deposit)(loan_period)(loan_persent) ) }
+
+void database_fixture::approve_credit( account_id_type creditor, const credit_object& credit )
+{ try {
+   set_expiration( db, trx );
+   trx.operations.clear();
+   credit_approve_operation op;
+   op.fee = asset( 1 );
+   op.creditor = creditor;
+   op.credit_request_uuid = credit.object_uuid;
+   trx.operations.push_back( op );
+   trx.validate();
+   db.push_transaction( trx, ~0 );
+   trx.operations.clear();
+   verify_asset_supplies( db );
+} FC_CAPTURE_AND_RETHROW( (creditor)(credit.id) ) }
+
+void database_fixture::settle_credit( const credit_object& credit )
+{ try {
+   set_expiration( db, trx );
+   trx.operations.clear();
+   settle_credit_operation op;
+   op.fee = asset( 1 );
+   op.borrower = credit.borrower.borrower;
+   op.credit_request_uuid = credit.object_uuid;
+   trx.operations.push_back( op );
+   trx.validate();
+   db.push_transaction( trx, ~0 );
+   trx.operations.clear();
+   verify_asset_supplies( db );
+} FC_CAPTURE_AND_RETHROW( (credit.id) ) }
+
+void database_fixture::cancel_credit_request( const credit_object& credit )
+{ try {
+   set_expiration( db, trx );
+   trx.operations.clear();
+   credit_request_cancel_operation op;
+   op.fee = asset( 1 );
+   op.borrower = credit.borrower.borrower;
+   op.credit_request_uuid = credit.object_uuid;
+   trx.operations.push_back( op );
+   trx.validate();
+   db.push_transaction( trx, ~0 );
+   trx.operations.clear();
+   verify_asset_supplies( db );
+} FC_CAPTURE_AND_RETHROW( (credit.id) ) }
+
+void database_fixture::publish_exchange_rate( const string& symbol, double rate )
+{
+   const auto& rates = *db.get_index_type<exchange_rate_index>().indices().get<by_id>().begin();
+   db.modify( rates, [&]( exchange_rate_object& r ) {
+      r.last_exchange_rate[symbol] = rate;
+      r.last_update_block_num = db.head_block_num();
+   });
+}
+
 void database_fixture::transfer(
    account_id_type from,
    account_id_type to,
@@ -28,6 +28,7 @@
 #include <fc/io/json.hpp>
 #include <fc/smart_ref_impl.hpp>
 
+#include <graphene/chain/credit_object.hpp>
 #include <graphene/chain/operation_history_object.hpp>
 #include <graphene/market_history/market_history_plugin.hpp>
 
@@ -269,6 +270,13 @@ struct database_fixture {
    void transfer( account_id_type from, account_id_type to, const asset& amount, const asset& fee = asset() );
    void transfer( const account_object& from, const account_object& to, const asset& amount, const asset& fee = asset() );
    void fund_fee_pool( const account_object& from, const asset_object& asset_to_fund, const share_type amount );
+   const credit_object& request_credit( account_id_type borrower, const asset& loan, const asset& deposit,
+                                        uint32_t loan_period = 12, uint32_t loan_persent = 10 );
+   void approve_credit( account_id_type creditor, const credit_object& credit );
+   void settle_credit( const credit_object& credit );
+   void cancel_credit_request( const credit_object& credit );
+   /// sets the rate as if the head block had published its median, see database::process_exchange_rates
+   void publish_exchange_rate( const string& symbol, double rate );
    void enable_fees();
    void change_fees( const flat_set< fee_parameters >& new_params, uint32_t new_scale = 0 );
    void upgrade_to_lifetime_member( account_id_type account );
@@ -28,6 +28,7 @@
 
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/asset_object.hpp>
+#include <graphene/chain/credit_money.hpp>
 #include <graphene/chain/proposal_object.hpp>
 
 #include <graphene/db/simple_index.hpp>
@@ -35,6 +36,9 @@
 #include <fc/crypto/digest.hpp>
 #include "../common/database_fixture.hpp"
 
+#include <cmath>
+#include <sstream>
+
 using namespace graphene::chain;
 
 //BOOST_FIXTURE_TEST_SUITE( performance_tests, database_fixture )
@@ -51,6 +55,100 @@ BOOST_AUTO_TEST_CASE( sigcheck_benchmark )
    auto elapsed = end-start;
    wdump( ((100000.0*1000000.0) / elapsed.count()) );
 }
+BOOST_AUTO_TEST_CASE( credit_money_benchmark )
+{
+   asset_object loan;
+   loan.id = asset_id_type( 1 );
+   loan.precision = 5;
+   const uint32_t count = 1000000;
+
+   // the conversions as the credit code did them before credit_money
+   auto legacy_to_real = [&]( share_type amount ) {
+      std::stringstream ss( loan.amount_to_string( amount ) );
+      double r;
+      ss >> r;
+      return r;
+   };
+   auto legacy_from_real = [&]( double real ) {
+      return asset( real * pow( 10, loan.precision ), loan.get_id() );
+   };
+
+   double legacy_sum = 0;
+   auto start = fc::time_point::now();
+   for( uint32_t i = 0; i < count; ++i )
+      legacy_sum += legacy_to_real( legacy_from_real( i * 1.37 ).amount );
+   auto legacy_elapsed = fc::time_point::now() - start;
+
+   double sum = 0;
+   start = fc::time_point::now();
+   for( uint32_t i = 0; i < count; ++i )
+      sum += credit_money::from_real( loan, i * 1.37 ).to_real();
+   auto elapsed = fc::time_point::now() - start;
+
+   BOOST_CHECK_EQUAL( legacy_sum, sum );
+   for( uint32_t i = 0; i < count; i += 7 )
+   {
+      BOOST_CHECK_EQUAL( legacy_from_real( i * 1.37 ).amount.value, credit_money::from_real( loan, i * 1.37 ).amount().value );
+      BOOST_CHECK_EQUAL( legacy_to_real( int64_t( i ) * 7919 ), loan.amount_to_real( int64_t( i ) * 7919 ) );
+   }
+   wdump( (legacy_elapsed)(elapsed) );
+}
+
+BOOST_AUTO_TEST_CASE( undo_delta_benchmark )
+{
+   const uint32_t accounts = 10000;
+   const uint32_t blocks = 100;
+   const uint32_t changes_per_block = 500;
+
+   // applies blocks changing the karma of some accounts, then pops them all again
+   auto run = [&]( graphene::db::object_database& db ) {
+      vector<const account_object*> accts;
+      db._undo_db.disable();
+      for( uint32_t i = 0; i < accounts; ++i )
+         accts.push_back( &db.create<account_object>( [&]( account_object& a ) {
+            a.name = "account" + fc::to_string( i );
+            a.pi.firstName = std::string( 32, 'f' );
+            a.pi.lastName = std::string( 32, 'l' );
+            a.ba.bankName = std::string( 64, 'b' );
+            a.ai.about = std::string( 256, 'd' );
+         }));
+      db._undo_db.enable();
+      db._undo_db.set_max_size( blocks + 1 );
+
+      auto start = fc::time_point::now();
+      for( uint32_t b = 0; b < blocks; ++b )
+      {
+         auto session = db._undo_db.start_undo_session();
+         for( uint32_t i = 0; i < changes_per_block; ++i )
+            db.modify( *accts[( b * 7919 + i * 13 ) % accounts], []( account_object& a ){ a.karma += 0.01f; } );
+         session.commit();
+      }
+      // the last block is compacted when the next session starts
+      db._undo_db.start_undo_session().undo();
+      auto elapsed = fc::time_point::now() - start;
+      size_t bytes = db._undo_db.stored_bytes();
+
+      for( uint32_t b = 0; b < blocks; ++b )
+         db._undo_db.pop_commit();
+      for( const account_object* a : accts )
+         BOOST_CHECK_EQUAL( a->karma, 1.0f );
+
+      uint64_t bytes_per_block = bytes / blocks;
+      int64_t usec_per_block = elapsed.count() / blocks;
+      wdump( (bytes_per_block)(usec_per_block) );
+      return bytes;
+   };
+
+   graphene::db::object_database copies;
+   copies.add_index< graphene::db::primary_index<account_index> >();
+   size_t copied_bytes = run( copies );
+
+   database deltas;
+   size_t delta_bytes = run( deltas );
+
+   BOOST_CHECK_LT( delta_bytes, copied_bytes );
+}
+
 /*
 BOOST_AUTO_TEST_CASE( transfer_benchmark )
 {
@@ -1041,6 +1041,34 @@ BOOST_FIXTURE_TEST_CASE( bogus_signature, database_fixture )
    FC_LOG_AND_RETHROW()
 }
 
+BOOST_FIXTURE_TEST_CASE( stale_digest_signature, database_fixture )
+{
+   try
+   {
+      ACTORS( (alice)(bob) );
+      const asset_object& core = asset_id_type()(db);
+      transfer( committee_account, alice_id, core.amount( 100000 ) );
+
+      transfer_operation xfer_op;
+      xfer_op.from = alice_id;
+      xfer_op.to = bob_id;
+      xfer_op.amount = core.amount( 5000 );
+      xfer_op.fee = db.current_fee_schedule().calculate_fee( xfer_op );
+
+      trx.clear();
+      trx.operations.push_back( xfer_op );
+      sign( trx, alice_private_key );
+      trx.precompute_digests( db.get_chain_id() );
+
+      BOOST_TEST_MESSAGE( "Changing the amount after the digests were computed" );
+      // assigning to the fields keeps the digests, the signature must still be checked against the new content
+      trx.operations[0].get<transfer_operation>().amount = core.amount( 50000 );
+      GRAPHENE_REQUIRE_THROW( PUSH_TX( db, trx, database::skip_transaction_dupe_check ), fc::exception );
+      BOOST_CHECK_EQUAL( get_balance( bob_id, asset_id_type() ), 0 );
+   }
+   FC_LOG_AND_RETHROW()
+}
+
 BOOST_FIXTURE_TEST_CASE( voting_account, database_fixture )
 { try {
    ACTORS((nathan)(vikram));
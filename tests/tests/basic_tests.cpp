@@ -233,6 +233,38 @@ BOOST_AUTO_TEST_CASE( scaled_precision )
    GRAPHENE_CHECK_THROW( asset::scaled_precision(19), fc::exception );
 }
 
+BOOST_AUTO_TEST_CASE( precomputed_transaction_digests )
+{ try {
+   chain_id_type chain_id = fc::sha256::hash( string( "chain" ) );
+   signed_transaction trx;
+   trx.set_expiration( fc::time_point_sec( 1000 ) );
+   trx.operations.push_back( transfer_operation() );
+
+   transaction_id_type id = trx.id();
+   digest_type sig_digest = trx.sig_digest( chain_id );
+   trx.precompute_digests( chain_id );
+   BOOST_CHECK( trx.id() == id );
+   BOOST_CHECK( trx.sig_digest( chain_id ) == sig_digest );
+   BOOST_CHECK( trx.sig_digest( chain_id_type() ) != sig_digest );
+
+   // copies keep the digests, the mutators drop them
+   processed_transaction ptrx( trx );
+   BOOST_CHECK( ptrx.id() == id );
+   ptrx.set_expiration( fc::time_point_sec( 2000 ) );
+   BOOST_CHECK( ptrx.id() != id );
+   BOOST_CHECK( ptrx.sig_digest( chain_id ) != sig_digest );
+
+   trx.set_reference_block( block_id_type( "0000000a00000000000000000000000000000000" ) );
+   BOOST_CHECK( trx.id() != id );
+   trx.precompute_digests( chain_id );
+   trx.clear();
+   transaction empty;
+   empty.expiration = trx.expiration;
+   empty.ref_block_num = trx.ref_block_num;
+   empty.ref_block_prefix = trx.ref_block_prefix;
+   BOOST_CHECK( trx.id() == empty.id() );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( merkle_root )
 {
    signed_block block;
@@ -24,6 +24,7 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <graphene/chain/block_prefetcher.hpp>
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/exceptions.hpp>
 
@@ -36,9 +37,12 @@
 #include <graphene/utilities/tempdir.hpp>
 
 #include <fc/crypto/digest.hpp>
+#include <fc/io/fstream.hpp>
 
 #include "../common/database_fixture.hpp"
 
+#include <fstream>
+
 using namespace graphene::chain;
 using namespace graphene::chain::test;
 
@@ -125,6 +129,102 @@ BOOST_AUTO_TEST_CASE( block_database_test )
    }
 }
 
+BOOST_AUTO_TEST_CASE( block_database_chunk_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+
+      block_database bdb;
+      bdb.open( data_dir.path() );
+
+      vector<signed_block> blocks;
+      signed_block b;
+      for( uint32_t i = 0; i < 10; ++i )
+      {
+         if( i > 0 ) b.previous = b.id();
+         b.witness = witness_id_type(i+1);
+         blocks.push_back( b );
+      }
+      bdb.store_chunk( vector<signed_block>( blocks.begin(), blocks.begin() + 4 ) );
+      bdb.store_chunk( vector<signed_block>( blocks.begin() + 4, blocks.begin() + 8 ) );
+      bdb.store( blocks[8].id(), blocks[8] );
+      bdb.store( blocks[9].id(), blocks[9] );
+
+      for( uint32_t pass = 0; pass < 2; ++pass )
+      {
+         for( uint32_t i = 0; i < 10; ++i )
+         {
+            auto blk = bdb.fetch_by_number( i+1 );
+            BOOST_REQUIRE( blk.valid() );
+            BOOST_CHECK( blk->id() == blocks[i].id() );
+            BOOST_CHECK( bdb.fetch_optional( blocks[i].id() ).valid() );
+         }
+         BOOST_CHECK( bdb.last_id() == blocks[9].id() );
+
+         bdb.close();
+         bdb.open( data_dir.path() );
+      }
+
+      // a block of a chunk is replaced like any other
+      bdb.remove( blocks[9].id() );
+      bdb.remove( blocks[8].id() );
+      bdb.remove( blocks[7].id() );
+      BOOST_CHECK( bdb.last_id() == blocks[6].id() );
+      BOOST_CHECK( !bdb.contains( blocks[7].id() ) );
+      signed_block fork = blocks[7];
+      fork.witness = witness_id_type(100);
+      bdb.store( fork.id(), fork );
+      BOOST_CHECK( bdb.fetch_by_number( 8 )->witness == witness_id_type(100) );
+      BOOST_CHECK( bdb.fetch_by_number( 7 )->id() == blocks[6].id() );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( block_prefetcher_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+
+      block_database bdb;
+      bdb.open( data_dir.path() );
+      vector<block_id_type> ids;
+      signed_block b;
+      for( uint32_t i = 0; i < 100; ++i )
+      {
+         if( i > 0 ) b.previous = b.id();
+         b.witness = witness_id_type(i+1);
+         b.transaction_merkle_root = i == 41 ? checksum_type::hash( string( "bad root" ) ) : b.calculate_merkle_root();
+         bdb.store( b.id(), b );
+         ids.push_back( b.id() );
+      }
+
+      {
+         block_prefetcher prefetcher( bdb, 3, 90, chain_id_type(), false, 3, 20 );
+         for( uint32_t i = 3; i <= 90; ++i )
+         {
+            auto next = prefetcher.next();
+            BOOST_REQUIRE( next.valid() );
+            BOOST_CHECK( next->block.id() == ids[i-1] );
+            BOOST_CHECK_EQUAL( next->merkle_checked, i != 42 );
+         }
+         BOOST_CHECK( !prefetcher.next().valid() );
+      }
+
+      // a missing block ends the range, the prefetcher stops when it goes away
+      bdb.remove( ids[99] );
+      bdb.remove( ids[98] );
+      block_prefetcher prefetcher( bdb, 95, 150, chain_id_type() );
+      for( uint32_t i = 95; i <= 98; ++i )
+         BOOST_CHECK( prefetcher.next()->block.id() == ids[i-1] );
+      BOOST_CHECK( !prefetcher.next().valid() );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_CASE( generate_empty_blocks )
 {
    try {
@@ -184,6 +284,120 @@ BOOST_AUTO_TEST_CASE( generate_empty_blocks )
    }
 }
 
+BOOST_AUTO_TEST_CASE( chain_state_snapshot )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      fc::temp_directory snapshot_dir( graphene::utilities::temp_directory_path() );
+      const fc::path snapshot = snapshot_dir.path() / "snapshot";
+      auto init_account_priv_key = fc::ecc::private_key::regenerate(fc::sha256::hash(string("null_key")) );
+
+      block_id_type snapshot_head;
+      block_id_type last_head;
+      size_t account_count = 0;
+      object_id_type next_account_id;
+      {
+         database db;
+         db.open(data_dir.path(), make_genesis, "TEST");
+         for( uint32_t i = 0; i < 80; ++i )
+            db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, database::skip_nothing);
+         // the head block is still reversible
+         GRAPHENE_REQUIRE_THROW( db.save_snapshot( snapshot ), fc::exception );
+         BOOST_CHECK( !fc::exists( snapshot ) );
+         last_head = db.head_block_id();
+         db.close();
+      }
+
+      // the snapshot is written while replaying, the blocks older than the last 50 are applied without undo history
+      {
+         database db;
+         db.applied_block.connect( [&]( const signed_block& b ) {
+            if( b.block_num() != 20 )
+               return;
+            db.save_snapshot( snapshot );
+            snapshot_head = b.id();
+            account_count = db.get_index_type<account_index>().indices().size();
+            next_account_id = db.get_index_type<account_index>().get_next_id();
+         });
+         // another database version wipes the object graph and replays the blocks
+         db.open(data_dir.path(), make_genesis, "TEST-REPLAY");
+         BOOST_CHECK( fc::exists( snapshot ) );
+         BOOST_CHECK( !fc::exists( snapshot.generic_string() + ".tmp" ) );
+         BOOST_CHECK( db.head_block_id() == last_head );
+         db.close();
+      }
+
+      // a new node starts at the head block of the snapshot and produces blocks on top of it
+      {
+         fc::temp_directory new_dir( graphene::utilities::temp_directory_path() );
+         database db;
+         db.open(new_dir.path(), make_genesis, "TEST", snapshot);
+         BOOST_CHECK( db.head_block_id() == snapshot_head );
+         BOOST_CHECK_EQUAL( db.get_index_type<account_index>().indices().size(), account_count );
+         BOOST_CHECK( db.get_index_type<account_index>().get_next_id() == next_account_id );
+         BOOST_CHECK( db.fetch_block_by_number( block_header::num_from_id( snapshot_head ) )->id() == snapshot_head );
+         db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, database::skip_nothing);
+         BOOST_CHECK_EQUAL( db.head_block_num(), block_header::num_from_id( snapshot_head ) + 1 );
+      }
+
+      // a node with the blocks after the snapshot replays only those
+      {
+         database db;
+         db.open(data_dir.path(), make_genesis, "TEST", snapshot);
+         BOOST_CHECK( db.head_block_id() == last_head );
+         db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, database::skip_nothing);
+         last_head = db.head_block_id();
+         db.close();
+      }
+
+      // a restart with the snapshot still given goes on from the stored objects
+      {
+         database db;
+         db.open(data_dir.path(), make_genesis, "TEST", snapshot);
+         BOOST_CHECK( db.head_block_id() == last_head );
+         db.close();
+      }
+
+      // the blocks of another fork are not dropped for the snapshot
+      {
+         fc::temp_directory other_dir( graphene::utilities::temp_directory_path() );
+         block_id_type other_head;
+         {
+            database db;
+            db.open(other_dir.path(), make_genesis, "TEST");
+            for( uint32_t i = 0; i < 25; ++i )
+               db.generate_block(db.get_slot_time(2), db.get_scheduled_witness(2), init_account_priv_key, database::skip_nothing);
+            other_head = db.head_block_id();
+            db.close();
+         }
+         {
+            database db;
+            BOOST_CHECK_THROW( db.open(other_dir.path(), make_genesis, "TEST", snapshot), fc::exception );
+         }
+         database db;
+         db.open(other_dir.path(), make_genesis, "TEST");
+         BOOST_CHECK( db.head_block_id() == other_head );
+      }
+
+      // a damaged snapshot is refused
+      {
+         std::string content;
+         fc::read_file_contents( snapshot, content );
+         const fc::path damaged = snapshot_dir.path() / "damaged";
+         std::ofstream out( damaged.generic_string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+         out.write( content.data(), content.size() - 1 );
+         out.close();
+
+         fc::temp_directory new_dir( graphene::utilities::temp_directory_path() );
+         database db;
+         BOOST_CHECK_THROW( db.open(new_dir.path(), make_genesis, "TEST", damaged), fc::exception );
+      }
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_CASE( undo_block )
 {
    try {
@@ -553,6 +767,101 @@ BOOST_AUTO_TEST_CASE( duplicate_transactions )
    }
 }
 
+BOOST_AUTO_TEST_CASE( block_signature_recovery )
+{
+   try {
+      fc::temp_directory dir1( graphene::utilities::temp_directory_path() ),
+                         dir2( graphene::utilities::temp_directory_path() );
+      database db1,
+               db2;
+      db1.open(dir1.path(), make_genesis, "TEST");
+      db2.open(dir2.path(), make_genesis, "TEST");
+
+      auto skip_sigs = database::skip_transaction_signatures | database::skip_authority_check;
+      auto init_account_priv_key  = fc::ecc::private_key::regenerate(fc::sha256::hash(string("null_key")) );
+      public_key_type init_account_pub_key  = init_account_priv_key.get_public_key();
+
+      vector<account_id_type> senders;
+      for( uint32_t i = 0; i < 4; ++i )
+      {
+         signed_transaction trx;
+         set_expiration( db1, trx );
+         account_create_operation cop;
+         cop.name = "sender" + fc::to_string(i);
+         cop.owner = authority(1, init_account_pub_key, 1);
+         cop.active = cop.owner;
+         trx.operations.push_back(cop);
+         trx.sign( init_account_priv_key, db1.get_chain_id() );
+         PUSH_TX( db1, trx, skip_sigs );
+
+         senders.push_back( db1.get_index_type<account_index>().indices().get<by_name>().find( cop.name )->id );
+         trx = signed_transaction();
+         set_expiration( db1, trx );
+         transfer_operation t;
+         t.to = senders.back();
+         t.amount = asset(500);
+         trx.operations.push_back(t);
+         trx.sign( init_account_priv_key, db1.get_chain_id() );
+         PUSH_TX( db1, trx, skip_sigs );
+      }
+      auto b = db1.generate_block( db1.get_slot_time(1), db1.get_scheduled_witness( 1 ), init_account_priv_key, skip_sigs );
+      PUSH_BLOCK( db2, b, skip_sigs );
+
+      // the keys of all transactions of a block are recovered together and checked against their authorities
+      auto transfer_from = [&]( account_id_type from, bool extra_signature ) {
+         signed_transaction trx;
+         set_expiration( db1, trx );
+         transfer_operation t;
+         t.from = from;
+         t.to = account_id_type();
+         t.amount = asset(100);
+         trx.operations.push_back(t);
+         trx.sign( init_account_priv_key, db1.get_chain_id() );
+         if( extra_signature )
+            trx.sign( fc::ecc::private_key::regenerate(fc::sha256::hash(string("bogus"))), db1.get_chain_id() );
+         PUSH_TX( db1, trx, skip_sigs );
+      };
+      for( account_id_type sender : senders )
+         transfer_from( sender, false );
+      b = db1.generate_block( db1.get_slot_time(1), db1.get_scheduled_witness( 1 ), init_account_priv_key, skip_sigs );
+      BOOST_CHECK_EQUAL( b.transactions.size(), 4 );
+
+      // keys recovered for pushed transactions are not recovered again for the block
+      for( const auto& trx : b.transactions )
+         PUSH_TX( db2, trx );
+      uint64_t hits = db2.get_signature_key_cache().hits();
+      uint64_t misses = db2.get_signature_key_cache().misses();
+      BOOST_CHECK_EQUAL( misses, 4 );
+      PUSH_BLOCK( db2, b );
+      BOOST_CHECK_EQUAL( db2.get_signature_key_cache().hits(), hits + 4 );
+      BOOST_CHECK_EQUAL( db2.get_signature_key_cache().misses(), misses );
+      BOOST_CHECK_EQUAL( db2.get_balance( senders[0], asset_id_type() ).amount.value, 400 );
+
+      // a transaction changed after its digests were computed keeps the merkle root and the signatures of the
+      // block valid as long as the digests are trusted
+      transfer_from( senders[1], false );
+      b = db1.generate_block( db1.get_slot_time(1), db1.get_scheduled_witness( 1 ), init_account_priv_key, skip_sigs );
+      BOOST_REQUIRE_EQUAL( b.transactions.size(), 1 );
+      signed_block changed = b;
+      changed.transactions[0].operations[0].get<transfer_operation>().amount = asset(300);
+      BOOST_CHECK( changed.calculate_merkle_root() == changed.transaction_merkle_root );
+      GRAPHENE_REQUIRE_THROW( PUSH_BLOCK( db2, changed ), fc::exception );
+      BOOST_CHECK_EQUAL( db2.get_balance( senders[1], asset_id_type() ).amount.value, 400 );
+      PUSH_BLOCK( db2, b );
+      BOOST_CHECK_EQUAL( db2.get_balance( senders[1], asset_id_type() ).amount.value, 300 );
+
+      for( uint32_t i = 0; i < senders.size(); ++i )
+         transfer_from( senders[i], i == 2 );
+      b = db1.generate_block( db1.get_slot_time(1), db1.get_scheduled_witness( 1 ), init_account_priv_key, skip_sigs );
+      GRAPHENE_REQUIRE_THROW( PUSH_BLOCK( db2, b ), fc::exception );
+      BOOST_CHECK( db2.head_block_id() != b.id() );
+      BOOST_CHECK_EQUAL( db2.get_balance( senders[0], asset_id_type() ).amount.value, 400 );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_CASE( tapos )
 {
    try {
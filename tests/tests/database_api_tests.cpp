@@ -124,4 +124,277 @@ BOOST_AUTO_TEST_CASE( get_potential_signatures_other ) {
    } FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE( credit_marketplace_events ) {
+   try {
+      ACTORS( (borrower)(lender) );
+      const asset_id_type depo_id = create_user_issued_asset( "DEPO" ).id;
+      issue_uia( borrower, asset( 100000, depo_id ) );
+      transfer( committee_account, borrower_id, asset( 1000 * GRAPHENE_BLOCKCHAIN_PRECISION ) );
+      transfer( committee_account, lender_id, asset( 1000 * GRAPHENE_BLOCKCHAIN_PRECISION ) );
+      publish_exchange_rate( "DEPO", 1.0 );
+      generate_block();
+
+      graphene::app::database_api db_api(db);
+      vector<graphene::app::credit_marketplace_event> events;
+      db_api.subscribe_to_credit_marketplace( [&events]( const variant& updates ) {
+         for( const variant& update : updates.get_array() )
+            events.push_back( update["event"].as<graphene::app::credit_marketplace_event>() );
+      }, graphene::app::credit_request_filter() );
+
+      // evaluators stamp the history with the time of the previous block, the events must not depend on it
+      const auto next_events = [&]() {
+         generate_block();
+         fc::usleep(fc::milliseconds(200));
+         vector<graphene::app::credit_marketplace_event> result;
+         std::swap( result, events );
+         return result;
+      };
+      typedef vector<graphene::app::credit_marketplace_event> events_type;
+
+      const asset loan( 100 * GRAPHENE_BLOCKCHAIN_PRECISION );
+      const credit_object& settled = request_credit( borrower_id, loan, asset( 40000, depo_id ) );
+      BOOST_CHECK( next_events() == events_type{ graphene::app::credit_requested } );
+      approve_credit( lender_id, settled );
+      BOOST_CHECK( next_events() == events_type{ graphene::app::credit_approved } );
+      settle_credit( settled );
+      BOOST_CHECK( next_events() == events_type{ graphene::app::credit_settled } );
+      BOOST_CHECK( settled.status == e_credit_object_status::complete_normal );
+
+      const credit_object& defaulted = request_credit( borrower_id, loan, asset( 40000, depo_id ) );
+      approve_credit( lender_id, defaulted );
+      // created and approved in one block the credit is reported as requested only
+      BOOST_CHECK( next_events() == events_type{ graphene::app::credit_requested } );
+      BOOST_CHECK( next_events().empty() );
+
+      // the deposit loses its margin and the stop-loss closes the credit in the next block
+      publish_exchange_rate( "DEPO", 0.1 );
+      BOOST_CHECK( next_events() == events_type{ graphene::app::credit_defaulted } );
+      BOOST_CHECK( defaulted.status == e_credit_object_status::complete_ubnormal );
+
+      const credit_object& cancelled = request_credit( borrower_id, loan, asset( 40000, depo_id ) );
+      BOOST_CHECK( next_events() == events_type{ graphene::app::credit_requested } );
+      cancel_credit_request( cancelled );
+      BOOST_CHECK( next_events() == events_type{ graphene::app::credit_cancelled } );
+
+      db_api.unsubscribe_from_credit_marketplace();
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( list_credit_requests_pages ) {
+   try {
+      ACTORS( (alice)(bob)(carol) );
+      const asset_id_type uia_id = create_user_issued_asset( "LOANUIA" ).id;
+      issue_uia( carol, asset( 1000000, uia_id ) );
+      transfer( committee_account, alice_id, asset( 1000 * GRAPHENE_BLOCKCHAIN_PRECISION ) );
+      transfer( committee_account, bob_id, asset( 1000 * GRAPHENE_BLOCKCHAIN_PRECISION ) );
+      transfer( committee_account, carol_id, asset( 1000 * GRAPHENE_BLOCKCHAIN_PRECISION ) );
+      publish_exchange_rate( "LOANUIA", 1.0 );
+      generate_block();
+
+      // four requests per block, so pages also end between credits of the same creation time
+      vector<credit_id_type> created;
+      for( uint32_t b = 0; b < 3; ++b )
+      {
+         for( uint32_t i = 0; i < 4; ++i )
+         {
+            asset loan = i < 2 ? asset( ( 10 + b * 4 + i ) * GRAPHENE_BLOCKCHAIN_PRECISION )
+                               : asset( ( 10 + b * 4 + i ) * 100, uia_id );
+            created.push_back( request_credit( i % 2 ? bob_id : alice_id, loan, asset( 0 ), 12, 5 + i ).id );
+         }
+         generate_block();
+      }
+      for( size_t i = 0; i < created.size(); i += 3 )
+         approve_credit( carol_id, created[i](db) );
+      generate_block();
+
+      const string core_symbol = asset_id_type()(db).symbol;
+      struct filter_case
+      {
+         graphene::app::credit_request_filter           filter;
+         std::function<bool(const credit_object&)>      matches;
+      };
+      vector<filter_case> cases;
+      const auto add_case = [&cases]( std::function<void(graphene::app::credit_request_filter&)> set,
+                                      std::function<bool(const credit_object&)> matches ) {
+         graphene::app::credit_request_filter filter;
+         set( filter );
+         cases.push_back( filter_case{ filter, matches } );
+      };
+      add_case( []( graphene::app::credit_request_filter& ) {},
+                []( const credit_object& ) { return true; } );
+      add_case( []( graphene::app::credit_request_filter& f ) { f.borrower = string( "alice" ); },
+                [&]( const credit_object& c ) { return c.borrower.borrower == alice_id; } );
+      add_case( [&]( graphene::app::credit_request_filter& f ) { f.borrower = string( object_id_type( bob_id ) ); },
+                [&]( const credit_object& c ) { return c.borrower.borrower == bob_id; } );
+      add_case( []( graphene::app::credit_request_filter& f ) { f.creditor = string( "carol" ); },
+                [&]( const credit_object& c ) { return c.creditor.creditor == carol_id; } );
+      add_case( []( graphene::app::credit_request_filter& f ) {
+                   f.loan_asset = string( "LOANUIA" );
+                   f.status = e_credit_object_status::wating_for_acceptance;
+                },
+                [&]( const credit_object& c ) {
+                   return c.borrower.loan_asset.asset_id == uia_id && c.status == e_credit_object_status::wating_for_acceptance;
+                } );
+      add_case( [&]( graphene::app::credit_request_filter& f ) {
+                   f.loan_asset = core_symbol;
+                   f.status = e_credit_object_status::in_progress;
+                },
+                [&]( const credit_object& c ) {
+                   return c.borrower.loan_asset.asset_id == asset_id_type() && c.status == e_credit_object_status::in_progress;
+                } );
+      add_case( []( graphene::app::credit_request_filter& f ) { f.loan_asset = string( "LOANUIA" ); },
+                [&]( const credit_object& c ) { return c.borrower.loan_asset.asset_id == uia_id; } );
+      add_case( []( graphene::app::credit_request_filter& f ) {
+                   f.borrower = string( "bob" );
+                   f.creditor = string( "carol" );
+                },
+                [&]( const credit_object& c ) { return c.borrower.borrower == bob_id && c.creditor.creditor == carol_id; } );
+      add_case( []( graphene::app::credit_request_filter& f ) {
+                   f.borrower = string( "alice" );
+                   f.loan_asset = string( "LOANUIA" );
+                   f.status = e_credit_object_status::wating_for_acceptance;
+                },
+                [&]( const credit_object& c ) {
+                   return c.borrower.borrower == alice_id && c.borrower.loan_asset.asset_id == uia_id &&
+                          c.status == e_credit_object_status::wating_for_acceptance;
+                } );
+      add_case( [&]( graphene::app::credit_request_filter& f ) {
+                   f.creditor = string( "carol" );
+                   f.loan_asset = core_symbol;
+                   f.status = e_credit_object_status::in_progress;
+                },
+                [&]( const credit_object& c ) {
+                   return c.creditor.creditor == carol_id && c.borrower.loan_asset.asset_id == asset_id_type() &&
+                          c.status == e_credit_object_status::in_progress;
+                } );
+      add_case( []( graphene::app::credit_request_filter& f ) {
+                   f.loan_persent_from = 6;
+                   f.loan_persent_to = 7;
+                   f.loan_volume_from = 12;
+                },
+                [&]( const credit_object& c ) {
+                   double volume = c.borrower.loan_asset.asset_id(db).amount_to_real( c.borrower.loan_asset.amount );
+                   return c.borrower.loan_persent >= 6 && c.borrower.loan_persent <= 7 && volume >= 12;
+                } );
+      add_case( []( graphene::app::credit_request_filter& f ) { f.borrower = string( "nobody" ); },
+                []( const credit_object& ) { return false; } );
+
+      graphene::app::database_api db_api(db);
+      const auto& by_time = db.get_index_type<credit_index>().indices().get<by_request_creation_time>();
+      for( const filter_case& test : cases )
+      {
+         vector<object_id_type> expected;
+         for( auto itr = by_time.rbegin(); itr != by_time.rend(); ++itr )
+            if( test.matches( *itr ) )
+               expected.push_back( itr->id );
+
+         for( uint32_t limit : { 1u, 2u, 5u, 100u } )
+         {
+            vector<object_id_type> listed;
+            optional<graphene::app::credit_request_cursor> start;
+            do
+            {
+               graphene::app::credit_request_page page = db_api.list_credit_requests( test.filter, start, limit );
+               BOOST_CHECK_LE( page.credits.size(), limit );
+               BOOST_CHECK( page.next.valid() ? page.credits.size() == limit : true );
+               for( const credit_object& credit : page.credits )
+                  listed.push_back( credit.id );
+               start = page.next;
+            } while( start.valid() && listed.size() <= expected.size() );
+            BOOST_CHECK( listed == expected );
+         }
+      }
+      BOOST_CHECK_THROW( db_api.list_credit_requests( graphene::app::credit_request_filter(), optional<graphene::app::credit_request_cursor>(), 101 ), fc::exception );
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( fetch_credit_requests_compatibility ) {
+   try {
+      ACTORS( (alice)(bob)(carol) );
+      const asset_id_type uia_id = create_user_issued_asset( "LOANUIA" ).id;
+      issue_uia( carol, asset( 1000000, uia_id ) );
+      transfer( committee_account, alice_id, asset( 1000 * GRAPHENE_BLOCKCHAIN_PRECISION ) );
+      transfer( committee_account, bob_id, asset( 1000 * GRAPHENE_BLOCKCHAIN_PRECISION ) );
+      transfer( committee_account, carol_id, asset( 1000 * GRAPHENE_BLOCKCHAIN_PRECISION ) );
+      publish_exchange_rate( "LOANUIA", 1.0 );
+      generate_block();
+
+      vector<credit_id_type> created;
+      for( uint32_t b = 0; b < 2; ++b )
+      {
+         for( uint32_t i = 0; i < 4; ++i )
+         {
+            asset loan = i < 2 ? asset( ( 10 + b * 4 + i ) * GRAPHENE_BLOCKCHAIN_PRECISION )
+                               : asset( ( 10 + b * 4 + i ) * 100, uia_id );
+            created.push_back( request_credit( i % 2 ? bob_id : alice_id, loan, asset( 0 ), 12, 5 + i ).id );
+         }
+         generate_block();
+      }
+      for( size_t i = 0; i < created.size(); i += 3 )
+         approve_credit( carol_id, created[i](db) );
+      generate_block();
+
+      // the scan over all credits the calls did before they were served from the filtered indices
+      const auto& by_time = db.get_index_type<credit_index>().indices().get<by_request_creation_time>();
+      const auto scan = [&]( uint32_t from_index, uint32_t elements_count, uint32_t persent_from, uint32_t persent_to,
+                             uint32_t volume_from, uint32_t volume_to, const string& symbol, const string& name,
+                             uint32_t status, bool by_creditor ) {
+         vector<object_id_type> result;
+         if( from_index > by_time.size() )
+            return result;
+         auto itr = by_time.rbegin();
+         std::advance( itr, from_index );
+         for( ; itr != by_time.rend(); ++itr )
+         {
+            const asset_object& loan = itr->borrower.loan_asset.asset_id(db);
+            if( name.size() > 0 && ( by_creditor ? itr->creditor.creditor : itr->borrower.borrower ) != get_account( name ).id )
+               continue;
+            if( symbol.size() > 0 && loan.symbol != symbol )
+               continue;
+            if( status != e_credit_object_status::fetch_all && itr->status != status )
+               continue;
+            if( itr->borrower.loan_persent < persent_from || itr->borrower.loan_persent > persent_to )
+               continue;
+            double volume = loan.amount_to_real( itr->borrower.loan_asset.amount );
+            if( volume < ( double )volume_from || volume > ( double )volume_to )
+               continue;
+            result.push_back( itr->id );
+            if( result.size() >= elements_count )
+               break;
+         }
+         return result;
+      };
+      const auto ids = []( const vector<credit_object>& credits ) {
+         vector<object_id_type> result;
+         for( const credit_object& credit : credits )
+            result.push_back( credit.id );
+         return result;
+      };
+
+      graphene::app::database_api db_api(db);
+      const uint32_t max = std::numeric_limits<uint32_t>::max();
+      const uint32_t all = e_credit_object_status::fetch_all;
+      const uint32_t waiting = e_credit_object_status::wating_for_acceptance;
+      const uint32_t running = e_credit_object_status::in_progress;
+      for( uint32_t from_index = 0; from_index <= created.size() + 1; ++from_index )
+      {
+         for( uint32_t count : { 1u, 3u, 100u } )
+         {
+            BOOST_CHECK( ids( db_api.fetch_credit_requests_stack( from_index, count, 0, max, 0, max, 0, max, "", "", all ) )
+                         == scan( from_index, count, 0, max, 0, max, "", "", all, false ) );
+            BOOST_CHECK( ids( db_api.fetch_credit_requests_stack( from_index, count, 0, max, 0, max, 0, max, "", "bob", all ) )
+                         == scan( from_index, count, 0, max, 0, max, "", "bob", all, false ) );
+            BOOST_CHECK( ids( db_api.fetch_credit_requests_stack( from_index, count, 6, 7, 0, max, 12, max, "LOANUIA", "alice", waiting ) )
+                         == scan( from_index, count, 6, 7, 12, max, "LOANUIA", "alice", waiting, false ) );
+            BOOST_CHECK( ids( db_api.fetch_credit_requests_stack( from_index, count, 0, max, 0, max, 0, max, "LOANUIA", "", waiting ) )
+                         == scan( from_index, count, 0, max, 0, max, "LOANUIA", "", waiting, false ) );
+            BOOST_CHECK( ids( db_api.fetch_credit_requests_stack_by_creditor( from_index, count, 0, max, 0, max, 0, max, "", "carol", all ) )
+                         == scan( from_index, count, 0, max, 0, max, "", "carol", all, true ) );
+            BOOST_CHECK( ids( db_api.fetch_credit_requests_stack_by_creditor( from_index, count, 0, max, 0, max, 0, max, "LOANUIA", "carol", running ) )
+                         == scan( from_index, count, 0, max, 0, max, "LOANUIA", "carol", running, true ) );
+         }
+      }
+   } FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_SUITE_END()
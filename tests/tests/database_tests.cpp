@@ -27,6 +27,8 @@
 #include <graphene/chain/database.hpp>
 
 #include <graphene/chain/account_object.hpp>
+#include <graphene/chain/credit_object.hpp>
+#include <graphene/chain/credit_statistics_object.hpp>
 
 #include <fc/crypto/digest.hpp>
 
@@ -62,6 +64,381 @@ BOOST_AUTO_TEST_CASE( undo_test )
    }
 }
 
+BOOST_AUTO_TEST_CASE( undo_cloned_objects_test )
+{
+   try {
+      database db;
+      const auto& bal_obj = db.create<account_balance_object>( [&]( account_balance_object& obj ){} );
+      const auto count_balances = [&]() {
+         return db._undo_db.cloned_objects( account_balance_object::space_id, account_balance_object::type_id );
+      };
+
+      db._undo_db.enable();
+      auto ses = db._undo_db.start_undo_session();
+      BOOST_CHECK_EQUAL( count_balances(), 0u );
+
+      // objects created in this session are not cloned when modified
+      const auto& new_obj = db.create<account_balance_object>( [&]( account_balance_object& obj ){} );
+      db.modify( new_obj, [&]( account_balance_object& obj ){ obj.balance = 1; } );
+      BOOST_CHECK_EQUAL( count_balances(), 0u );
+
+      // pre-existing objects are cloned once per session
+      db.modify( bal_obj, [&]( account_balance_object& obj ){ obj.balance = 2; } );
+      db.modify( bal_obj, [&]( account_balance_object& obj ){ obj.balance = 3; } );
+      BOOST_CHECK_EQUAL( count_balances(), 1u );
+      BOOST_CHECK_EQUAL( db._undo_db.cloned_objects( account_statistics_object::space_id,
+                                                     account_statistics_object::type_id ), 0u );
+
+      ses.undo();
+      BOOST_CHECK( bal_obj.balance == 0 );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( overdue_credit_not_cloned_test )
+{
+   try {
+      ACTORS( (borrower)(lender) );
+      generate_block();
+      db.clear_pending();
+
+      const time_point_sec start = db.head_block_time();
+      const credit_object& credit = db.create<credit_object>( [&]( credit_object& c ) {
+         memset( c.uuid_key.data, 0, sizeof( c.uuid_key.data ) );
+         c.status = e_credit_object_status::in_progress;
+         c.borrower.borrower = borrower_id;
+         c.borrower.loan_asset = asset( 1000 * GRAPHENE_BLOCKCHAIN_PRECISION );
+         c.borrower.loan_period = 12;
+         c.borrower.deposit_asset = asset( 0 );
+         c.borrower.collateral_free = true;
+         c.creditor.creditor = lender_id;
+         c.creditor.monthly_payment = 1.0;
+         c.request_creation_time = start;
+         c.request_approvation_time = start;
+         c.settle_month_elapsed = 0;
+         // missed its first payment and due on every block, as credits were scheduled before
+         c.expired_time_start = start.sec_since_epoch();
+         c.next_process_time = start;
+      });
+
+      // the borrower cannot pay, so the credit is only moved to its deadline once
+      generate_block();
+      BOOST_CHECK_EQUAL( db.last_block_credit_undo_clones(), 1u );
+      BOOST_CHECK( credit.next_process_time == credit.overdue_deadline( db ) );
+      for( int i = 0; i < 3; ++i )
+      {
+         generate_block();
+         BOOST_CHECK_EQUAL( db.last_block_credit_undo_clones(), 0u );
+      }
+      BOOST_CHECK_EQUAL( credit.expired_time_start, start.sec_since_epoch() );
+
+      // funds of the borrower settle the payment in the block that brings them
+      transfer( committee_account, borrower_id, asset( 2 * GRAPHENE_BLOCKCHAIN_PRECISION ) );
+      generate_block();
+      BOOST_CHECK_EQUAL( db.last_block_credit_undo_clones(), 1u );
+      BOOST_CHECK_EQUAL( credit.expired_time_start, 0u );
+      BOOST_CHECK_EQUAL( credit.settle_month_elapsed, 1u );
+      BOOST_CHECK_EQUAL( db.get_balance( borrower_id, asset_id_type() ).amount.value, int64_t( GRAPHENE_BLOCKCHAIN_PRECISION ) );
+      BOOST_CHECK( credit.next_process_time == credit.next_payment_time( db ) );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( overdue_credits_funded_in_pass_test )
+{
+   try {
+      ACTORS( (first)(second)(lender) );
+      generate_block();
+      db.clear_pending();
+
+      const time_point_sec start = db.head_block_time();
+      const auto create_overdue = [&]( account_id_type borrower, account_id_type creditor ) -> const credit_object& {
+         return db.create<credit_object>( [&]( credit_object& c ) {
+            memset( c.uuid_key.data, 0, sizeof( c.uuid_key.data ) );
+            c.status = e_credit_object_status::in_progress;
+            c.borrower.borrower = borrower;
+            c.borrower.loan_asset = asset( 1000 * GRAPHENE_BLOCKCHAIN_PRECISION );
+            c.borrower.loan_period = 12;
+            c.borrower.deposit_asset = asset( 0 );
+            c.borrower.collateral_free = true;
+            c.creditor.creditor = creditor;
+            c.creditor.monthly_payment = 1.0;
+            c.request_creation_time = start;
+            c.request_approvation_time = start;
+            c.settle_month_elapsed = 0;
+            c.expired_time_start = start.sec_since_epoch();
+            c.next_process_time = start;
+         });
+      };
+      // the payment of the first credit funds the borrower of the second one, which comes later in creation order
+      const credit_object& first_credit = create_overdue( first_id, second_id );
+      const credit_object& second_credit = create_overdue( second_id, lender_id );
+      generate_block();
+      BOOST_CHECK_EQUAL( first_credit.expired_time_start, start.sec_since_epoch() );
+
+      // funds of a pending transaction that is dropped settle nothing
+      transfer( committee_account, first_id, asset( GRAPHENE_BLOCKCHAIN_PRECISION ) );
+      db.clear_pending();
+      generate_block();
+      BOOST_CHECK_EQUAL( db.last_block_credit_undo_clones(), 0u );
+      BOOST_CHECK_EQUAL( first_credit.expired_time_start, start.sec_since_epoch() );
+
+      transfer( committee_account, first_id, asset( GRAPHENE_BLOCKCHAIN_PRECISION ) );
+      generate_block();
+      BOOST_CHECK_EQUAL( first_credit.expired_time_start, 0u );
+      BOOST_CHECK_EQUAL( second_credit.expired_time_start, 0u );
+      BOOST_CHECK_EQUAL( second_credit.settle_month_elapsed, 1u );
+      BOOST_CHECK_EQUAL( db.get_balance( second_id, asset_id_type() ).amount.value, 0 );
+      BOOST_CHECK_EQUAL( db.get_balance( lender_id, asset_id_type() ).amount.value, int64_t( GRAPHENE_BLOCKCHAIN_PRECISION ) );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( published_rate_defaults_credit_test )
+{
+   try {
+      ACTORS( (borrower)(lender) );
+      const asset_id_type depo_id = create_user_issued_asset( "DEPO" ).id;
+      issue_uia( borrower, asset( 100000, depo_id ) );
+      transfer( committee_account, borrower_id, asset( 1000 * GRAPHENE_BLOCKCHAIN_PRECISION ) );
+      transfer( committee_account, lender_id, asset( 1000 * GRAPHENE_BLOCKCHAIN_PRECISION ) );
+      publish_exchange_rate( "DEPO", 1.0 );
+      generate_block();
+
+      // at a rate of 0.375 the first deposit is worth exactly the stop-loss margin of 150% of the loan,
+      // the second one a single satoshi more
+      const asset loan( 100 * GRAPHENE_BLOCKCHAIN_PRECISION );
+      const credit_object& at_margin = request_credit( borrower_id, loan, asset( 40000, depo_id ) );
+      const credit_object& above_margin = request_credit( borrower_id, loan, asset( 40001, depo_id ) );
+      approve_credit( lender_id, at_margin );
+      approve_credit( lender_id, above_margin );
+      generate_blocks( 2 );
+
+      // neither credit is due before its first payment, only the published rate can close them
+      const time_point_sec above_margin_process_time = above_margin.next_process_time;
+      BOOST_CHECK( at_margin.next_process_time > db.head_block_time() );
+      BOOST_CHECK( above_margin_process_time > db.head_block_time() );
+
+      publish_exchange_rate( "DEPO", 0.375 );
+      BOOST_CHECK( at_margin.needs_processing( db ) );
+      BOOST_CHECK( !above_margin.needs_processing( db ) );
+
+      // the block right after the publication closes the credit, as the check of every credit would
+      generate_block();
+      BOOST_CHECK( at_margin.status == e_credit_object_status::complete_ubnormal );
+      BOOST_CHECK_EQUAL( at_margin.borrower.deposit_asset.amount.value, 0 );
+      BOOST_CHECK( above_margin.status == e_credit_object_status::in_progress );
+      BOOST_CHECK_EQUAL( above_margin.borrower.deposit_asset.amount.value, 40001 );
+      BOOST_CHECK( above_margin.next_process_time == above_margin_process_time );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( credit_statistics_test )
+{
+   try {
+      ACTORS( (borrower)(lender) );
+      const asset_id_type depo_id = create_user_issued_asset( "DEPO" ).id;
+      issue_uia( borrower, asset( 100000, depo_id ) );
+      transfer( committee_account, borrower_id, asset( 1000 * GRAPHENE_BLOCKCHAIN_PRECISION ) );
+      transfer( committee_account, lender_id, asset( 1000 * GRAPHENE_BLOCKCHAIN_PRECISION ) );
+      publish_exchange_rate( "DEPO", 1.0 );
+      generate_block();
+
+      // the statistics have to equal the sums over all credits after every change
+      const auto check_statistics = [&]() {
+         map<asset_id_type, credit_totals> totals;
+         map<std::pair<account_id_type, asset_id_type>, credit_totals> as_borrower;
+         map<std::pair<account_id_type, asset_id_type>, credit_totals> as_creditor;
+         for( const credit_object& credit : db.get_index_type<credit_index>().indices() )
+         {
+            credit_statistics_state state( credit );
+            flat_set<asset_id_type> assets{ state.loan.asset_id, state.deposit.asset_id };
+            for( asset_id_type asset : assets )
+            {
+               credit_totals part = credit_totals::of( state, asset );
+               totals[asset] += part;
+               as_borrower[std::make_pair( state.borrower, asset )] += part;
+               if( state.status != e_credit_object_status::wating_for_acceptance &&
+                   state.status != e_credit_object_status::cancalled )
+                  as_creditor[std::make_pair( state.creditor, asset )] += part;
+            }
+         }
+
+         const auto& statistics = db.get_index_type<credit_statistics_index>().indices();
+         for( const credit_statistics_object& s : statistics )
+            BOOST_CHECK( s.totals == totals[s.asset] );
+         for( const auto& item : totals )
+            BOOST_CHECK( item.second == credit_totals() ||
+                         statistics.get<by_asset>().find( item.first ) != statistics.get<by_asset>().end() );
+
+         const auto& account_statistics = db.get_index_type<account_credit_statistics_index>().indices();
+         for( const account_credit_statistics_object& s : account_statistics )
+         {
+            BOOST_CHECK( s.as_borrower == as_borrower[std::make_pair( s.account, s.asset )] );
+            BOOST_CHECK( s.as_creditor == as_creditor[std::make_pair( s.account, s.asset )] );
+         }
+         for( const auto& parts : { as_borrower, as_creditor } )
+            for( const auto& item : parts )
+               BOOST_CHECK( item.second == credit_totals() ||
+                            account_statistics.get<by_account_asset>().find( boost::make_tuple( item.first.first, item.first.second ) )
+                            != account_statistics.get<by_account_asset>().end() );
+      };
+
+      const asset loan( 100 * GRAPHENE_BLOCKCHAIN_PRECISION );
+      const credit_object& paid = request_credit( borrower_id, loan, asset( 40000, depo_id ) );
+      check_statistics();
+      generate_block();
+      approve_credit( lender_id, paid );
+      check_statistics();
+      generate_block();
+      check_statistics();
+
+      // the first monthly payment moves the inflows of the creditor
+      generate_blocks( paid.next_payment_time( db ) );
+      generate_block();
+      BOOST_CHECK_EQUAL( paid.settle_month_elapsed, 1u );
+      BOOST_CHECK( paid.monthly_inflows > 0 );
+      check_statistics();
+
+      settle_credit( paid );
+      check_statistics();
+      generate_block();
+      BOOST_CHECK( paid.status == e_credit_object_status::complete_normal );
+      check_statistics();
+
+      // the deposit loses its margin after a new rate and the credit defaults
+      const credit_object& defaulted = request_credit( borrower_id, loan, asset( 40000, depo_id ) );
+      approve_credit( lender_id, defaulted );
+      generate_block();
+      check_statistics();
+      publish_exchange_rate( "DEPO", 0.1 );
+      generate_block();
+      BOOST_CHECK( defaulted.status == e_credit_object_status::complete_ubnormal );
+      check_statistics();
+
+      const credit_object& cancelled = request_credit( borrower_id, loan, asset( 40000, depo_id ) );
+      generate_block();
+      check_statistics();
+      cancel_credit_request( cancelled );
+      check_statistics();
+      generate_block();
+      check_statistics();
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( karma_rank_test )
+{
+   try {
+      vector<account_id_type> accounts;
+      for( int i = 0; i < 20; ++i )
+         accounts.push_back( create_account( "rank" + fc::to_string( i ) ).id );
+
+      const auto& karma_index = db.get_index_type<account_index>().get_secondary_index<account_karma_index>();
+      const auto check_ranks = [&]() {
+         for( float karma = -0.5f; karma <= KARMA_MAX_VALUE + 0.5f; karma += 0.25f )
+         {
+            uint32_t expected = 0;
+            for( const account_object& a : db.get_index_type<account_index>().indices() )
+               if( a.karma > karma )
+                  ++expected;
+            BOOST_CHECK_EQUAL( karma_index.count_above( karma ), expected );
+         }
+      };
+      const auto set_karma = [&]( account_id_type id, float karma ) {
+         db.modify( id( db ), [karma]( account_object& a ) { a.karma = karma; } );
+      };
+
+      // ties share the rank of the accounts above them
+      for( size_t i = 0; i < accounts.size(); ++i )
+         set_karma( accounts[i], 0.5f * ( i % 5 ) + 2.5f );
+      check_ranks();
+      BOOST_CHECK_EQUAL( karma_index.count_above( accounts[0]( db ).karma ), karma_index.count_above( accounts[5]( db ).karma ) );
+      BOOST_CHECK_EQUAL( karma_index.count_above( 4.5f ), 0u );
+      BOOST_CHECK_EQUAL( karma_index.count_above( 4.0f ), 4u );
+
+      // values move between groups, leave them and open new ones
+      for( size_t i = 0; i < accounts.size(); ++i )
+      {
+         set_karma( accounts[i], float( i ) * 0.2f + 0.1f );
+         check_ranks();
+      }
+      for( size_t i = 0; i < accounts.size(); i += 2 )
+         db.modify( accounts[i]( db ), []( account_object& a ) { a.update_karma( KARMA_PENALTY_FOR_CREDIT_DEFAULT ); } );
+      check_ranks();
+      BOOST_CHECK_EQUAL( karma_index.count_above( KARMA_MAX_VALUE ), 0u );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( undo_delta_test )
+{
+   try {
+      database db;
+      const auto& acct = db.create<account_object>( [&]( account_object& obj ){
+         obj.name = "delta";
+         obj.pi.firstName = std::string( 1000, 'x' );
+      });
+      const auto count_accounts = [&]() {
+         return db._undo_db.cloned_objects( account_object::space_id, account_object::type_id );
+      };
+
+      db._undo_db.enable();
+      {
+         auto block = db._undo_db.start_undo_session();
+         db.modify( acct, [&]( account_object& obj ){ obj.karma = 2.0; } );
+         block.commit();
+      }
+      const size_t copied_bytes = db._undo_db.stored_bytes();
+
+      // starting the next session turns the copy of the committed state into a delta
+      auto ses = db._undo_db.start_undo_session();
+      BOOST_CHECK_LT( db._undo_db.stored_bytes(), copied_bytes / 10 );
+      BOOST_CHECK_EQUAL( count_accounts(), 0u );
+
+      // a merge expands the delta against the copy taken by the merged session
+      db.modify( acct, [&]( account_object& obj ){ obj.karma = 3.0; obj.pi.firstName = "short"; } );
+      ses.merge();
+      BOOST_CHECK_EQUAL( count_accounts(), 1u );
+
+      // and a later modification expands it against the current value
+      {
+         auto next = db._undo_db.start_undo_session();
+         next.commit();
+      }
+      db._undo_db.pop_commit();
+      db.modify( acct, [&]( account_object& obj ){ obj.karma = 4.0; } );
+
+      db._undo_db.pop_commit();
+      BOOST_CHECK_EQUAL( acct.karma, 1.0f );
+      BOOST_CHECK_EQUAL( acct.pi.firstName, std::string( 1000, 'x' ) );
+      BOOST_CHECK_EQUAL( acct.name, "delta" );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_CASE( flat_index_test )
 {
    ACTORS((sam));